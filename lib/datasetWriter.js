@@ -0,0 +1,66 @@
+/*
+ * datasetWriter.js
+ */
+
+const native = require('bindings')('comparative_parquet')
+
+const ParquetFileDatasetWriter = native.ParquetDatasetWriter
+
+class ParquetDatasetWriter {
+  dirpath = null
+  schema = null
+  options = null
+  writer = null
+
+  /**
+   * @param {Object} schema
+   * @param {string} dirpath
+   * @param {Object} [options]
+   * @param {string[]} [options.partitionBy]   hive-style partition columns
+   * @param {number} [options.maxRowsPerFile]  start a new file after this many rows
+   * @param {number} [options.maxBytesPerFile] start a new file after about this many (uncompressed) bytes
+   * @param {number} [options.concurrency]     number of native threads writing files, defaults to the core count
+   * @param {number} [options.maxOpenPartitions] partitions buffered and open at once, defaults to 256
+   * @param {boolean} [options.preserveOrder]  fill one file at a time per partition, so rows read back in order
+   * @param {{ column: string, order?: 'asc'|'desc' }[]} [options.sortBy] sort each batch before it is encoded
+   */
+  constructor(schema, dirpath, options = {}) {
+    this.dirpath = dirpath
+    this.schema = schema
+    this.options = options
+    this.writer = new ParquetFileDatasetWriter(schema, dirpath, options)
+  }
+
+  appendRow(row) {
+    this.writer.appendRowArray(row)
+  }
+
+  appendRowObject(row) {
+    const rowArray = []
+    for (const key in this.schema) {
+      rowArray.push(row[key])
+    }
+    this.writer.appendRowArray(rowArray)
+  }
+
+  open() {
+    this.writer.open()
+  }
+
+  close() {
+    this.writer.close()
+  }
+
+  setRowGroupSize(size) {
+    this.writer.setRowGroupSize(size)
+  }
+}
+
+/** Creates a dataset writer and opens its directory directly */
+ParquetDatasetWriter.openDirectory = function openDirectory(schema, dirpath, options) {
+  const writer = new ParquetDatasetWriter(schema, dirpath, options)
+  writer.open()
+  return writer
+}
+
+module.exports = ParquetDatasetWriter
@@ -1,11 +1,13 @@
 const ParquetReader = require('./reader.js')
 const ParquetWriter = require('./writer.js')
+const ParquetDatasetWriter = require('./datasetWriter.js')
 const type = require('./fieldType.js')
 const timeUnit = require('./timeUnit.js')
 
 module.exports = {
   ParquetReader,
   ParquetWriter,
+  ParquetDatasetWriter,
   type,
   timeUnit,
 }
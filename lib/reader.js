@@ -10,6 +10,20 @@ const native = require('bindings')('comparative_parquet')
 
 const ParquetFileReader = native.ParquetReader
 
+// Sidecar key index written by ParquetWriter#setIndexColumns
+const KEY_INDEX_EXTENSION = '.idx'
+
+/** Lists files recursively, so hive-style `key=value/` directories are included */
+function listFiles(dirpath) {
+  return fs.readdirSync(dirpath, { withFileTypes: true })
+    .filter(entry => !entry.name.endsWith(KEY_INDEX_EXTENSION))
+    .sort((a, b) => a.name.localeCompare(b.name, undefined, { numeric: true }))
+    .flatMap(entry => {
+      const entryPath = path.join(dirpath, entry.name)
+      return entry.isDirectory() ? listFiles(entryPath) : [entryPath]
+    })
+}
+
 class ParquetReader {
   filepath = null
   files = null
@@ -21,7 +35,7 @@ class ParquetReader {
 
     const stat = fs.statSync(filepath)
     if (stat.isDirectory()) {
-      this.files = fs.readdirSync(filepath).map(filename => path.join(filepath, filename))
+      this.files = listFiles(filepath)
       if (this.files.length === 0)
         throw new Error('Empty directory')
     }
@@ -100,6 +114,55 @@ class ParquetReader {
 
     return this.readers[readerIndex].readRowAsArray(actualIndex)
   }
+
+  /**
+   * Returns the `[{ column, order }]` order every row group of every file is
+   * sorted by, or an empty array. Row groups are sorted individually, so the
+   * dataset as a whole is not necessarily in that order.
+   */
+  getSortingColumns() {
+    const [first, ...others] = this.execute(r => r.getSortingColumns())
+    const same = others.every(columns => JSON.stringify(columns) === JSON.stringify(first))
+    return same ? first : []
+  }
+
+  /**
+   * Returns the rows in `rowRange` ([start, end), all rows by default) of
+   * `columns` (all columns by default) as an Arrow IPC stream Buffer, which
+   * `apache-arrow` reads with `tableFromIPC`.
+   *
+   * The columns are serialized into the stream, which is one copy. When the
+   * range spans several files of a directory, their streams are joined into
+   * a single one natively, which copies the data a second time.
+   */
+  readArrowIPC(columns = null, rowRange = [0, this.getRowCount()]) {
+    const [start, end] = rowRange
+    const buffers = []
+    let offset = 0
+    this.execute((r, i) => {
+      const fileStart = Math.max(start - offset, 0)
+      const fileEnd = Math.min(end - offset, this.rowCounts[i])
+      if (fileStart < fileEnd || (buffers.length === 0 && i === this.readers.length - 1))
+        buffers.push(r.readArrowIPC(columns, fileStart, Math.max(fileStart, fileEnd)))
+      offset += this.rowCounts[i]
+    })
+    return buffers.length === 1 ? buffers[0] : native.concatArrowIPC(buffers)
+  }
+
+  /**
+   * Returns the indices of the rows where `column` equals `value`, or any of
+   * the values if an array is given.
+   */
+  findRows(column, value) {
+    const results = []
+    let offset = 0
+    this.execute((r, i) => {
+      for (const row of r.findRows(column, value))
+        results.push(offset + row)
+      offset += this.rowCounts[i]
+    })
+    return results
+  }
 }
 
 
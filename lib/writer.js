@@ -12,10 +12,18 @@ class ParquetWriter {
   schema = null
   writer = null
 
-  constructor(schema, filepath) {
+  /**
+   * @param {Object} schema
+   * @param {string} filepath
+   * @param {Object} [options]
+   * @param {{ column: string, order?: 'asc'|'desc' }[]} [options.sortBy] sort rows before they are encoded
+   */
+  constructor(schema, filepath, options = {}) {
     this.filepath = filepath
     this.schema = schema
     this.writer = new ParquetFileWriter(schema, filepath)
+    if (options.sortBy)
+      this.writer.setSortBy(options.sortBy)
   }
 
   appendRow(row) {
@@ -30,6 +38,13 @@ class ParquetWriter {
     this.writer.appendRowArray(rowArray)
   }
 
+  /** Appends the record batches of an Arrow IPC stream, e.g. from `tableToIPC(table, 'stream')` */
+  writeArrowIPC(buffer) {
+    if (!Buffer.isBuffer(buffer))
+      buffer = Buffer.from(buffer.buffer, buffer.byteOffset, buffer.byteLength)
+    this.writer.writeArrowIPC(buffer)
+  }
+
   open() {
     this.writer.open()
   }
@@ -41,11 +56,16 @@ class ParquetWriter {
   setRowGroupSize(size) {
     this.writer.setRowGroupSize(size)
   }
+
+  /** Writes a sidecar key index for these columns, used by ParquetReader#findRows */
+  setIndexColumns(columns) {
+    this.writer.setIndexColumns(columns)
+  }
 }
 
 /** Creates a writer and opens file directly */
-ParquetWriter.openFile = function openFile(schema, filepath) {
-  const writer = new ParquetWriter(schema, filepath)
+ParquetWriter.openFile = function openFile(schema, filepath, options) {
+  const writer = new ParquetWriter(schema, filepath, options)
   writer.open()
   return writer
 }
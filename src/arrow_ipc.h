@@ -0,0 +1,124 @@
+#ifndef ARROW_IPC_H
+#define ARROW_IPC_H
+
+#include <napi.h>
+
+#include <arrow/api.h>
+#include <arrow/io/memory.h>
+#include <arrow/ipc/api.h>
+
+#include <cstring>
+
+// Helpers to move whole tables across the JS boundary as Arrow IPC streams,
+// the format `apache-arrow` reads with `tableFromIPC` and writes with
+// `tableToIPC(table, 'stream')`.
+
+/** Serializes table as an IPC stream */
+static std::shared_ptr<arrow::Buffer> TableToIPC(const arrow::Table& table) {
+  auto sink = arrow::io::BufferOutputStream::Create();
+  if (!sink.ok())
+    throw std::runtime_error(sink.status().ToString());
+
+  auto writer = arrow::ipc::MakeStreamWriter(sink->get(), table.schema());
+  if (!writer.ok())
+    throw std::runtime_error(writer.status().ToString());
+
+  auto status = (*writer)->WriteTable(table);
+  if (status.ok())
+    status = (*writer)->Close();
+  if (!status.ok())
+    throw std::runtime_error(status.ToString());
+
+  auto buffer = (*sink)->Finish();
+  if (!buffer.ok())
+    throw std::runtime_error(buffer.status().ToString());
+  return *buffer;
+}
+
+/** Reads an IPC stream; the table references buffer's memory without copying */
+static std::shared_ptr<arrow::Table> TableFromIPC(const std::shared_ptr<arrow::Buffer>& buffer) {
+  auto input = std::make_shared<arrow::io::BufferReader>(buffer);
+  auto reader = arrow::ipc::RecordBatchStreamReader::Open(input);
+  if (!reader.ok())
+    throw std::runtime_error(reader.status().ToString());
+
+  arrow::RecordBatchVector batches;
+  while (true) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+    auto status = (*reader)->ReadNext(&batch);
+    if (!status.ok())
+      throw std::runtime_error(status.ToString());
+    if (!batch)
+      break;
+    batches.push_back(batch);
+  }
+
+  auto table = arrow::Table::FromRecordBatches((*reader)->schema(), batches);
+  if (!table.ok())
+    throw std::runtime_error(table.status().ToString());
+  return *table;
+}
+
+/** Wraps a Node buffer without copying; only valid while the JS value is alive */
+inline static std::shared_ptr<arrow::Buffer> WrapNapiBuffer(const Napi::Buffer<uint8_t>& buffer) {
+  return std::make_shared<arrow::Buffer>(buffer.Data(), buffer.Length());
+}
+
+/** Copies a Node buffer into arrow-owned memory, for data that outlives the call */
+static std::shared_ptr<arrow::Buffer> CopyNapiBuffer(const Napi::Buffer<uint8_t>& buffer) {
+  auto result = arrow::AllocateBuffer(buffer.Length());
+  if (!result.ok())
+    throw std::runtime_error(result.status().ToString());
+  std::shared_ptr<arrow::Buffer> copy = std::move(*result);
+  std::memcpy(copy->mutable_data(), buffer.Data(), buffer.Length());
+  return copy;
+}
+
+/** Hands an arrow buffer to JS without copying; JS keeps it alive */
+static Napi::Buffer<uint8_t> NapiBufferFromArrow(Napi::Env env, const std::shared_ptr<arrow::Buffer>& buffer) {
+  auto holder = new std::shared_ptr<arrow::Buffer>(buffer);
+  return Napi::Buffer<uint8_t>::New(
+    env,
+    const_cast<uint8_t*>(buffer->data()),
+    buffer->size(),
+    [](Napi::Env, uint8_t*, std::shared_ptr<arrow::Buffer>* hint) { delete hint; },
+    holder);
+}
+
+namespace ArrowIPC {
+  /** concatArrowIPC(buffers: Buffer[]): Buffer, joins streams that share a schema */
+  inline Napi::Value Concat(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+      Napi::TypeError::New(env, "buffers:Buffer[] expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    auto buffers = info[0].As<Napi::Array>();
+    try {
+      std::vector<std::shared_ptr<arrow::Table>> tables;
+      for (uint32_t i = 0; i < buffers.Length(); i++) {
+        tables.push_back(TableFromIPC(WrapNapiBuffer(buffers.Get(i).As<Napi::Buffer<uint8_t>>())));
+      }
+      if (tables.empty())
+        throw std::runtime_error("At least one buffer expected");
+
+      auto table = arrow::ConcatenateTables(tables);
+      if (!table.ok())
+        throw std::runtime_error(table.status().ToString());
+
+      // Serialize before returning, the inputs only borrow the JS buffers
+      return NapiBufferFromArrow(env, TableToIPC(**table));
+    } catch (const std::runtime_error& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  inline Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    exports.Set("concatArrowIPC", Napi::Function::New(env, Concat, "concatArrowIPC"));
+    return exports;
+  }
+};
+
+#endif // ARROW_IPC_H
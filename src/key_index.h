@@ -0,0 +1,236 @@
+#ifndef KEY_INDEX_H
+#define KEY_INDEX_H
+
+#include <arrow/api.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Sidecar key index written next to a parquet file as `<file>.idx`.
+//
+// For every indexed column it stores the hash of each non-null value along
+// with its row number, sorted by hash. A lookup binary-searches the hash and
+// gets back candidate rows, which the reader then checks against the actual
+// values to rule out collisions.
+//
+// The header records the row count and byte size of the parquet file it was
+// built for. A sidecar that doesn't match the file, or can't be parsed, is
+// ignored and lookups fall back to scanning.
+//
+// Layout (native byte order):
+//
+//   char[8]   magic "CPQIDX3\0"
+//   uint64    row count of the parquet file
+//   uint64    byte size of the parquet file
+//   uint32    column count
+//   for each column:
+//     uint32    name length, followed by the name bytes
+//     uint64    entry count, followed by that many KeyIndexEntry
+
+static const char KEY_INDEX_MAGIC[8] = { 'C', 'P', 'Q', 'I', 'D', 'X', '3', '\0' };
+
+static std::string const KEY_INDEX_EXTENSION = ".idx";
+
+struct KeyIndexEntry {
+  uint64_t hash;
+  uint64_t row;
+
+  bool operator<(const KeyIndexEntry& other) const {
+    return hash < other.hash || (hash == other.hash && row < other.row);
+  }
+};
+
+/** FNV-1a, stable across runs so it can be persisted */
+inline static uint64_t HashBytes(const uint8_t* data, size_t length) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * Hashes the raw bytes of the value at index, which must not be null.
+ * Floating point zeros are hashed as +0.0, since -0.0 compares equal.
+ */
+static uint64_t HashArrayValue(const arrow::Array& array, int64_t index) {
+  switch (array.type_id()) {
+  case arrow::Type::type::BOOL: {
+    uint8_t value = static_cast<const arrow::BooleanArray&>(array).Value(index);
+    return HashBytes(&value, 1);
+  }
+
+  case arrow::Type::type::FLOAT: {
+    auto value = static_cast<const arrow::FloatArray&>(array).Value(index);
+    if (value == 0)
+      value = 0;
+    return HashBytes(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+  }
+
+  case arrow::Type::type::DOUBLE: {
+    auto value = static_cast<const arrow::DoubleArray&>(array).Value(index);
+    if (value == 0)
+      value = 0;
+    return HashBytes(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+  }
+
+  case arrow::Type::type::STRING:
+  case arrow::Type::type::BINARY: {
+    auto view = static_cast<const arrow::BinaryArray&>(array).GetView(index);
+    return HashBytes(reinterpret_cast<const uint8_t*>(view.data()), view.size());
+  }
+
+  case arrow::Type::type::FIXED_SIZE_BINARY: {
+    auto& fixed = static_cast<const arrow::FixedSizeBinaryArray&>(array);
+    return HashBytes(fixed.GetValue(index), fixed.byte_width());
+  }
+
+  default: {
+    auto& type = dynamic_cast<const arrow::FixedWidthType&>(*array.type());
+    auto width = type.bit_width() / 8;
+    auto data = array.data()->buffers[1]->data() + (array.offset() + index) * width;
+    return HashBytes(data, width);
+  }
+  }
+}
+
+template <typename T>
+inline static void WritePod(std::ofstream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+inline static void ReadPod(std::ifstream& in, T& value) {
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  if (!in)
+    throw std::runtime_error("Truncated key index");
+}
+
+/** Writes the sidecar index for the given columns of table, stored in a file of fileSize bytes */
+static void WriteKeyIndex(const std::string& filepath, const arrow::Table& table, const std::vector<int>& columns,
+                          uint64_t fileSize) {
+  std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("Failed to open key index: " + filepath);
+
+  out.write(KEY_INDEX_MAGIC, sizeof(KEY_INDEX_MAGIC));
+  WritePod(out, static_cast<uint64_t>(table.num_rows()));
+  WritePod(out, fileSize);
+  WritePod(out, static_cast<uint32_t>(columns.size()));
+
+  for (auto columnIndex : columns) {
+    std::vector<KeyIndexEntry> entries;
+    entries.reserve(table.num_rows());
+
+    uint64_t row = 0;
+    for (const auto& chunk : table.column(columnIndex)->chunks()) {
+      for (int64_t i = 0; i < chunk->length(); i++, row++) {
+        if (chunk->IsNull(i))
+          continue;
+        entries.push_back(KeyIndexEntry{HashArrayValue(*chunk, i), row});
+      }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    auto& name = table.schema()->field(columnIndex)->name();
+    WritePod(out, static_cast<uint32_t>(name.size()));
+    out.write(name.data(), name.size());
+    WritePod(out, static_cast<uint64_t>(entries.size()));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(KeyIndexEntry));
+  }
+
+  if (!out)
+    throw std::runtime_error("Failed to write key index: " + filepath);
+}
+
+class KeyIndex {
+  std::map<std::string, std::vector<KeyIndexEntry>> entriesByColumn;
+
+public:
+  /**
+   * Loads the sidecar at filepath. Returns null if there is none, if it was
+   * built for a different version of the parquet file, or if it is corrupt.
+   */
+  static std::unique_ptr<KeyIndex> Load(const std::string& filepath, uint64_t rowCount, uint64_t fileSize) {
+    try {
+      return Read(filepath, rowCount, fileSize);
+    } catch (const std::runtime_error&) {
+      return nullptr;
+    } catch (const std::bad_alloc&) {
+      return nullptr;
+    }
+  }
+
+  bool HasColumn(const std::string& column) const {
+    return entriesByColumn.count(column) != 0;
+  }
+
+  /** Appends the rows whose value hashes to hash; may include collisions */
+  void FindCandidates(const std::string& column, uint64_t hash, std::vector<int64_t>& rows) const {
+    auto& entries = entriesByColumn.at(column);
+    auto range = std::equal_range(entries.begin(), entries.end(), KeyIndexEntry{hash, 0},
+      [](const KeyIndexEntry& a, const KeyIndexEntry& b) { return a.hash < b.hash; });
+    for (auto it = range.first; it != range.second; ++it)
+      rows.push_back(static_cast<int64_t>(it->row));
+  }
+
+private:
+  static std::unique_ptr<KeyIndex> Read(const std::string& filepath, uint64_t rowCount, uint64_t fileSize) {
+    std::ifstream in(filepath, std::ios::binary | std::ios::ate);
+    if (!in)
+      return nullptr;
+    uint64_t size = in.tellg();
+    in.seekg(0);
+
+    char magic[sizeof(KEY_INDEX_MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, KEY_INDEX_MAGIC, sizeof(magic)) != 0)
+      return nullptr;
+
+    uint64_t indexedRowCount;
+    uint64_t indexedFileSize;
+    ReadPod(in, indexedRowCount);
+    ReadPod(in, indexedFileSize);
+    if (indexedRowCount != rowCount || indexedFileSize != fileSize)
+      return nullptr;
+
+    auto index = std::make_unique<KeyIndex>();
+
+    uint32_t columnCount;
+    ReadPod(in, columnCount);
+    for (uint32_t c = 0; c < columnCount; c++) {
+      uint32_t nameLength;
+      ReadPod(in, nameLength);
+      if (nameLength > size)
+        return nullptr;
+      std::string name(nameLength, '\0');
+      in.read(&name[0], nameLength);
+
+      // Checked against the file size before allocating, so a corrupt
+      // count can't trigger a huge allocation
+      uint64_t entryCount;
+      ReadPod(in, entryCount);
+      if (entryCount > rowCount || entryCount > size / sizeof(KeyIndexEntry))
+        return nullptr;
+
+      std::vector<KeyIndexEntry> entries(entryCount);
+      in.read(reinterpret_cast<char*>(entries.data()), entryCount * sizeof(KeyIndexEntry));
+      if (!in)
+        return nullptr;
+
+      index->entriesByColumn[name] = std::move(entries);
+    }
+
+    return index;
+  }
+};
+
+#endif // KEY_INDEX_H
@@ -1,12 +1,16 @@
 #include <napi.h>
 #include "parquet_reader.h"
 #include "parquet_writer.h"
+#include "parquet_dataset_writer.h"
 #include "types.h"
+#include "arrow_ipc.h"
 
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
   ParquetWriter::Init(env, exports);
+  ParquetDatasetWriter::Init(env, exports);
   ParquetReader::Init(env, exports);
   Types::Init(env, exports);
+  ArrowIPC::Init(env, exports);
   return exports;
 }
 
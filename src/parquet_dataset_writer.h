@@ -0,0 +1,603 @@
+#ifndef PARQUET_DATASET_WRITER_H
+#define PARQUET_DATASET_WRITER_H
+
+#include <napi.h>
+
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/properties.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "parquet_writer.h"
+
+// Number of finished batches a worker may have queued before appendRow
+// blocks, so a slow disk can't make buffered tables grow without bound.
+static size_t const MAX_PENDING_BATCHES = 4;
+
+static int64_t const DEFAULT_BATCH_ROWS = 64 * 1024;
+
+static size_t const DEFAULT_MAX_OPEN_PARTITIONS = 256;
+
+/**
+ * Owns one of the native threads that encode and write dataset files.
+ * Batches are handed over as finished tables tagged with their file; the
+ * thread sorts them if needed, then opens, writes and closes files in the
+ * order they were queued. A file is only ever given to a single worker.
+ */
+class DatasetWorker {
+  struct Task {
+    std::string filepath;
+    std::shared_ptr<arrow::Table> table;
+    bool closeFile;
+  };
+
+  struct OpenFile {
+    std::shared_ptr<arrow::io::FileOutputStream> outfile;
+    std::unique_ptr<parquet::arrow::FileWriter> writer;
+  };
+
+  ArrowSchemaPtr schema;
+  std::shared_ptr<parquet::WriterProperties> properties;
+  int64_t rowGroupSize;
+  std::vector<SortColumn> sortBy;
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<Task> tasks;
+  bool finished = false;
+  std::string error;
+
+  std::thread thread;
+
+public:
+  DatasetWorker(ArrowSchemaPtr schema, std::shared_ptr<parquet::WriterProperties> properties, int64_t rowGroupSize,
+                std::vector<SortColumn> sortBy)
+    : schema(std::move(schema))
+    , properties(std::move(properties))
+    , rowGroupSize(rowGroupSize)
+    , sortBy(std::move(sortBy))
+    , thread(&DatasetWorker::Run, this)
+  {}
+
+  ~DatasetWorker() {
+    Finish();
+  }
+
+  /** Queues a batch for the file at filepath, opening it if needed */
+  void Write(const std::string& filepath, std::shared_ptr<arrow::Table> table) {
+    Push(Task{filepath, std::move(table), false});
+  }
+
+  /** Queues closing the file at filepath */
+  void CloseFile(const std::string& filepath) {
+    Push(Task{filepath, nullptr, true});
+  }
+
+  /** Drains the queue, closes every open file and joins the thread */
+  void Finish() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+    cond.notify_all();
+    if (thread.joinable())
+      thread.join();
+  }
+
+  std::string Error() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+  }
+
+  /** Number of tasks queued and not yet picked up by the thread */
+  size_t Pending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.size();
+  }
+
+  /** Whether queuing another task would block until the thread catches up */
+  bool Busy() {
+    return Pending() >= MAX_PENDING_BATCHES;
+  }
+
+private:
+  void Push(Task task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return tasks.size() < MAX_PENDING_BATCHES || !error.empty(); });
+    if (!error.empty())
+      throw std::runtime_error(error);
+    tasks.push_back(std::move(task));
+    cond.notify_all();
+  }
+
+  void Run() {
+    std::map<std::string, OpenFile> files;
+
+    auto closeFile = [&](std::map<std::string, OpenFile>::iterator it) {
+      PARQUET_THROW_NOT_OK(it->second.writer->Close());
+      PARQUET_THROW_NOT_OK(it->second.outfile->Close());
+      return files.erase(it);
+    };
+
+    try {
+      while (true) {
+        Task task;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          cond.wait(lock, [this] { return !tasks.empty() || finished; });
+          if (tasks.empty())
+            break;
+          task = std::move(tasks.front());
+          tasks.pop_front();
+        }
+        cond.notify_all();
+
+        auto it = files.find(task.filepath);
+
+        if (task.closeFile) {
+          if (it != files.end())
+            closeFile(it);
+          continue;
+        }
+
+        if (it == files.end()) {
+          OpenFile file;
+          PARQUET_ASSIGN_OR_THROW(file.outfile, arrow::io::FileOutputStream::Open(task.filepath));
+          PARQUET_ASSIGN_OR_THROW(file.writer,
+            parquet::arrow::FileWriter::Open(*schema, arrow::default_memory_pool(), file.outfile, properties));
+          it = files.emplace(task.filepath, std::move(file)).first;
+        }
+
+        PARQUET_THROW_NOT_OK(it->second.writer->WriteTable(*SortTable(task.table, sortBy), rowGroupSize));
+      }
+
+      for (auto it = files.begin(); it != files.end();)
+        it = closeFile(it);
+    } catch (const std::exception& e) {
+      std::lock_guard<std::mutex> lock(mutex);
+      error = e.what();
+      tasks.clear();
+      cond.notify_all();
+    }
+  }
+};
+
+/** A file of a partition that is open on one of the workers */
+struct DatasetFile {
+  std::string filepath;
+  DatasetWorker* worker;
+  int64_t rows = 0;
+  int64_t bytes = 0;
+};
+
+struct DatasetPartition {
+  std::string key;
+  std::string directory;
+  std::vector<Column> columns;
+  int64_t bufferedRows = 0;
+  uint64_t lastUsed = 0;
+  // Open files, each on a different worker, and the one receiving the
+  // buffered rows; picked when the first row of a batch arrives, -1 before
+  std::vector<DatasetFile> files;
+  int current = -1;
+  size_t nextFile = 0;
+};
+
+// Hive's name for the partition of null values
+static std::string const HIVE_NULL_PARTITION = "__HIVE_DEFAULT_PARTITION__";
+static std::string const HIVE_EMPTY_PARTITION = "__HIVE_EMPTY_PARTITION__";
+
+/**
+ * Escapes a partition value so it can be used as a single path segment.
+ * Values that would read back as one of the sentinels above get their
+ * first character escaped, so every value maps to a distinct segment.
+ */
+static std::string EscapePartitionValue(const std::string& value) {
+  static const char* hex = "0123456789ABCDEF";
+  if (value.empty())
+    return HIVE_EMPTY_PARTITION;
+
+  auto reserved = value == "." || value == ".." || value.rfind("__HIVE_", 0) == 0;
+
+  std::string result;
+  for (size_t i = 0; i < value.size(); i++) {
+    unsigned char c = value[i];
+    if ((reserved && i == 0) || c < 0x20 || c == '/' || c == '\\' || c == '=' || c == '%' || c == ':' || c == '"'
+        || c == '*' || c == '?' || c == '<' || c == '>' || c == '|' || (c == '.' && reserved)) {
+      result += '%';
+      result += hex[c >> 4];
+      result += hex[c & 0xF];
+    } else {
+      result += c;
+    }
+  }
+  return result;
+}
+
+/** Bytes per row taken by the fixed-width columns, used for maxBytesPerFile */
+static int64_t FixedWidthRowBytes(const ArrowSchemaPtr& schema) {
+  int64_t size = 0;
+  for (const auto& field : schema->fields()) {
+    auto type = dynamic_cast<const arrow::FixedWidthType*>(field->type().get());
+    if (type)
+      size += std::max(type->bit_width() / 8, 1);
+  }
+  return size;
+}
+
+/**
+ * Bytes of string and binary data held by the builders. Sampled around an
+ * append, it gives the row's variable-width size without converting the
+ * JS values twice.
+ */
+static int64_t VariableWidthBytes(const std::vector<Column>& columns) {
+  int64_t size = 0;
+  for (const auto& column : columns) {
+    if (column.type == arrow::Type::type::STRING || column.type == arrow::Type::type::BINARY)
+      size += static_cast<const arrow::BinaryBuilder&>(*column.builder).value_data_length();
+  }
+  return size;
+}
+
+class ParquetDatasetWriter : public Napi::ObjectWrap<ParquetDatasetWriter> {
+protected:
+  std::string dirpath;
+  ArrowSchemaPtr schema;
+  parquet::WriterProperties::Builder propBuilder;
+  std::shared_ptr<parquet::WriterProperties> properties;
+
+  std::vector<int> partitionColumns;
+  std::vector<SortColumn> sortBy;
+  int64_t maxRowsPerFile = 0;
+  int64_t maxBytesPerFile = 0;
+  int64_t batchRows = DEFAULT_BATCH_ROWS;
+  size_t concurrency = 1;
+  size_t maxOpenPartitions = DEFAULT_MAX_OPEN_PARTITIONS;
+  bool preserveOrder = false;
+  int64_t fixedRowBytes = 0;
+
+  // A fixed pool of `concurrency` threads; a partition's files are spread
+  // over distinct workers so batches keep flowing while one is backed up
+  std::vector<std::unique_ptr<DatasetWorker>> workers;
+  size_t nextWorker = 0;
+
+  // Hive-style partitions are keyed by their relative directory, round-robin
+  // mode uses a single partition with an empty key. At most
+  // `maxOpenPartitions` hold builders and open files; the least recently
+  // used one is closed to make room and continues in new files if needed.
+  std::map<std::string, std::unique_ptr<DatasetPartition>> partitions;
+  std::map<std::string, int64_t> nextFileIndexByKey;
+  uint64_t useCounter = 0;
+  bool isOpen = false;
+
+public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func =
+      DefineClass(env,
+        "ParquetDatasetWriter", {
+          InstanceMethod("appendRowArray",       &ParquetDatasetWriter::AppendRowArray),
+          InstanceMethod("open",                 &ParquetDatasetWriter::Open),
+          InstanceMethod("close",                &ParquetDatasetWriter::Close),
+          InstanceMethod("setRowGroupSize",      &ParquetDatasetWriter::SetRowGroupSize),
+        });
+
+    auto constructor = new Napi::FunctionReference();
+    *constructor = Napi::Persistent(func);
+    env.SetInstanceData(constructor);
+
+    exports.Set("ParquetDatasetWriter", func);
+    return exports;
+  }
+
+public:
+  ParquetDatasetWriter(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<ParquetDatasetWriter>(info)
+  {
+    auto env = info.Env();
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsString()) {
+      Napi::TypeError::New(env, "schema:Object, path:string, options?:Object expected").ThrowAsJavaScriptException();
+      return;
+    }
+
+    dirpath = info[1].ToString().Utf8Value();
+
+    try {
+      schema = BuildSchema(info[0].As<Napi::Object>());
+    } catch (const std::runtime_error& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+      return;
+    }
+
+    concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+
+    if (info.Length() < 3 || !info[2].IsObject())
+      return;
+
+    auto options = info[2].As<Napi::Object>();
+
+    if (options.Has("partitionBy")) {
+      auto partitionBy = options.Get("partitionBy").As<Napi::Array>();
+      for (uint32_t i = 0; i < partitionBy.Length(); i++) {
+        auto name = partitionBy.Get(i).ToString().Utf8Value();
+        auto index = schema->GetFieldIndex(name);
+        if (index < 0) {
+          Napi::Error::New(env, "Unknown partition column: " + name).ThrowAsJavaScriptException();
+          return;
+        }
+        partitionColumns.push_back(index);
+      }
+    }
+    if (options.Has("maxRowsPerFile"))
+      maxRowsPerFile = options.Get("maxRowsPerFile").ToNumber().Int64Value();
+    if (options.Has("maxBytesPerFile"))
+      maxBytesPerFile = options.Get("maxBytesPerFile").ToNumber().Int64Value();
+    if (options.Has("concurrency"))
+      concurrency = std::max(options.Get("concurrency").ToNumber().Int64Value(), int64_t(1));
+    if (options.Has("maxOpenPartitions"))
+      maxOpenPartitions = std::max(options.Get("maxOpenPartitions").ToNumber().Int64Value(), int64_t(1));
+    if (options.Has("preserveOrder"))
+      preserveOrder = options.Get("preserveOrder").ToBoolean().Value();
+    if (options.Has("sortBy")) {
+      try {
+        sortBy = ParseSortBy(schema, options.Get("sortBy").As<Napi::Array>());
+      } catch (const std::runtime_error& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return;
+      }
+      // Every batch is sorted on its own and row groups never span batches,
+      // so the order holds per row group but not across a whole file
+      propBuilder.set_sorting_columns(ToSortingColumns(schema, sortBy));
+    }
+  }
+
+  ~ParquetDatasetWriter() {
+    // Workers must be joined before their std::thread is destroyed
+    for (auto& worker : workers)
+      worker->Finish();
+  }
+
+  Napi::Value AppendRowArray(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+      Napi::TypeError::New(env, "row:Array expected").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    if (!isOpen) {
+      Napi::Error::New(env, "Writer is not open").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    try {
+      auto row = info[0].As<Napi::Array>();
+      auto& partition = PartitionForRow(row);
+      if (partition.current < 0)
+        PickFile(partition);
+      auto current = partition.current;
+      auto& file = partition.files[current];
+      auto dataBytes = maxBytesPerFile > 0 ? VariableWidthBytes(partition.columns) : 0;
+
+      AppendRow(partition.columns, row);
+      partition.bufferedRows += 1;
+      file.rows += 1;
+      if (maxBytesPerFile > 0)
+        file.bytes += fixedRowBytes + VariableWidthBytes(partition.columns) - dataBytes;
+
+      auto fileFull =
+           (maxRowsPerFile > 0 && file.rows >= maxRowsPerFile)
+        || (maxBytesPerFile > 0 && file.bytes >= maxBytesPerFile);
+
+      if (fileFull || partition.bufferedRows >= batchRows)
+        FlushPartition(partition);
+      if (fileFull)
+        CloseFile(partition, current);
+    } catch (const std::exception& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    return env.Undefined();
+  }
+
+  Napi::Value Open(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+
+    std::error_code ec;
+    std::filesystem::create_directories(dirpath, ec);
+    if (ec) {
+      Napi::Error::New(env, "Failed to create directory: " + ec.message()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    properties = propBuilder.build();
+    fixedRowBytes = FixedWidthRowBytes(schema);
+    for (size_t i = 0; i < concurrency; i++)
+      workers.push_back(std::make_unique<DatasetWorker>(schema, properties, batchRows, sortBy));
+    isOpen = true;
+
+    return Napi::Boolean::New(env, true);
+  }
+
+  Napi::Value Close(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    std::string error;
+
+    for (auto& it : partitions) {
+      auto& partition = *it.second;
+      try {
+        FlushPartition(partition);
+      } catch (const std::exception& e) {
+        if (error.empty())
+          error = e.what();
+      }
+    }
+
+    // Every worker is finished before reporting, so no thread outlives close()
+    for (auto& worker : workers) {
+      worker->Finish();
+      if (error.empty())
+        error = worker->Error();
+    }
+
+    workers.clear();
+    partitions.clear();
+    nextFileIndexByKey.clear();
+    isOpen = false;
+
+    if (!error.empty()) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    return env.Undefined();
+  }
+
+  Napi::Value SetRowGroupSize(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+      Napi::TypeError::New(env, "size:number expected").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    batchRows = info[0].ToNumber().Int64Value();
+    propBuilder.max_row_group_length(batchRows);
+    return env.Undefined();
+  }
+
+protected:
+  DatasetPartition& PartitionForRow(const Napi::Array& row) {
+    std::string key;
+    for (auto index : partitionColumns) {
+      if (!key.empty())
+        key += '/';
+      auto value = row.Get(index);
+      auto text = value.IsNull() || value.IsUndefined()
+        ? HIVE_NULL_PARTITION
+        : EscapePartitionValue(value.ToString().Utf8Value());
+      key += schema->field(index)->name() + "=" + text;
+    }
+
+    auto it = partitions.find(key);
+    if (it != partitions.end()) {
+      it->second->lastUsed = ++useCounter;
+      return *it->second;
+    }
+
+    if (partitions.size() >= maxOpenPartitions)
+      EvictPartition();
+
+    auto partition = std::make_unique<DatasetPartition>();
+    partition->key = key;
+    partition->directory = (std::filesystem::path(dirpath) / key).string();
+    partition->columns = MakeColumns(schema);
+    partition->lastUsed = ++useCounter;
+    std::filesystem::create_directories(partition->directory);
+
+    auto& result = *partition;
+    partitions[key] = std::move(partition);
+    return result;
+  }
+
+  /** Closes the least recently used partition, keeping its file numbering */
+  void EvictPartition() {
+    auto oldest = std::min_element(partitions.begin(), partitions.end(),
+      [](const auto& a, const auto& b) { return a.second->lastUsed < b.second->lastUsed; });
+    auto& partition = *oldest->second;
+    FlushPartition(partition);
+    for (auto& file : partition.files)
+      file.worker->CloseFile(file.filepath);
+    partitions.erase(oldest);
+  }
+
+  /**
+   * Picks the file that receives the next batch of partition. With
+   * preserveOrder a partition fills one file at a time. Otherwise
+   * round-robin mode deals batches over `concurrency` files, and a hive
+   * partition stays on its file until that file's worker is backed up,
+   * then moves on to another one, opening a file on a new worker if needed.
+   */
+  void PickFile(DatasetPartition& partition) {
+    auto maxFiles = preserveOrder ? size_t(1) : workers.size();
+    auto count = partition.files.size();
+
+    if (count < maxFiles && partitionColumns.empty()) {
+      partition.current = StartFile(partition);
+      return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      auto index = (partition.nextFile + i) % count;
+      if (!partition.files[index].worker->Busy() || partitionColumns.empty()) {
+        partition.current = index;
+        partition.nextFile = index + 1;
+        return;
+      }
+    }
+
+    if (count < maxFiles) {
+      partition.current = StartFile(partition);
+      return;
+    }
+
+    // Every worker of the partition is backed up, Write will wait for one
+    partition.current = partition.nextFile % count;
+    partition.nextFile = partition.current + 1;
+  }
+
+  /** Opens the next file of partition on the least loaded worker it isn't using yet */
+  int StartFile(DatasetPartition& partition) {
+    DatasetWorker* worker = nullptr;
+    size_t workerIndex = 0;
+    size_t pending = 0;
+    for (size_t i = 0; i < workers.size(); i++) {
+      auto index = (nextWorker + i) % workers.size();
+      auto candidate = workers[index].get();
+      auto used = std::any_of(partition.files.begin(), partition.files.end(),
+        [&](const DatasetFile& file) { return file.worker == candidate; });
+      if (used)
+        continue;
+      auto candidatePending = candidate->Pending();
+      if (!worker || candidatePending < pending) {
+        worker = candidate;
+        workerIndex = index;
+        pending = candidatePending;
+      }
+    }
+    nextWorker = (workerIndex + 1) % workers.size();
+
+    auto filename = "part-" + std::to_string(nextFileIndexByKey[partition.key]++) + ".parquet";
+    DatasetFile file;
+    file.filepath = (std::filesystem::path(partition.directory) / filename).string();
+    file.worker = worker;
+    partition.files.push_back(file);
+    return partition.files.size() - 1;
+  }
+
+  void FlushPartition(DatasetPartition& partition) {
+    if (partition.bufferedRows == 0)
+      return;
+    auto& file = partition.files[partition.current];
+    file.worker->Write(file.filepath, FinishColumns(schema, partition.columns));
+    partition.bufferedRows = 0;
+    partition.current = -1;
+  }
+
+  /** Closes a full file; the partition's next batch goes elsewhere */
+  void CloseFile(DatasetPartition& partition, int index) {
+    auto& file = partition.files[index];
+    file.worker->CloseFile(file.filepath);
+    partition.files.erase(partition.files.begin() + index);
+    if (partition.nextFile > static_cast<size_t>(index))
+      partition.nextFile -= 1;
+  }
+};
+
+#endif // PARQUET_DATASET_WRITER_H
@@ -6,6 +6,18 @@
 #include <arrow/api.h>
 #include <arrow/io/api.h>
 #include <parquet/arrow/reader.h>
+#include <parquet/bloom_filter.h>
+#include <parquet/bloom_filter_reader.h>
+#include <parquet/exception.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
 
 using std::vector;
 using std::shared_ptr;
@@ -20,18 +32,237 @@ typedef shared_ptr<arrow::Field>        ArrowFieldPtr;
     Napi::Error::New(env, message).ThrowAsJavaScriptException(); \
     return env.Null(); } while(0)
 
+// Lookup values are converted with the writer's JS-to-arrow helpers
+#include "parquet_writer.h"
+
 static int64_t const MIN_SAFE_INTEGER = -9007199254740991L;
 static int64_t const MAX_SAFE_INTEGER =  9007199254740991L;
 
+template <typename StatsType, typename T>
+inline static bool InRange(const parquet::Statistics& stats, T value) {
+  auto& typed = static_cast<const StatsType&>(stats);
+  return !(value < typed.min() || typed.max() < value);
+}
+
+template <typename View>
+inline static bool BytesInRange(const parquet::Statistics& stats, View value) {
+  auto& typed = static_cast<const parquet::ByteArrayStatistics&>(stats);
+  auto min = View(reinterpret_cast<const char*>(typed.min().ptr), typed.min().len);
+  auto max = View(reinterpret_cast<const char*>(typed.max().ptr), typed.max().len);
+  return !(value < min || max < value);
+}
+
+/** Whether a row group with these statistics can contain the probe value */
+static bool StatisticsMayContain(const shared_ptr<parquet::Statistics>& stats, const arrow::Array& probe) {
+  if (!stats || !stats->HasMinMax())
+    return true;
+
+  // Unsigned and boolean columns are not pruned, their physical sort order
+  // doesn't match the comparisons below.
+  switch (probe.type_id()) {
+  case arrow::Type::INT8:
+    return InRange<parquet::Int32Statistics>(*stats, int32_t(static_cast<const arrow::Int8Array&>(probe).Value(0)));
+  case arrow::Type::INT16:
+    return InRange<parquet::Int32Statistics>(*stats, int32_t(static_cast<const arrow::Int16Array&>(probe).Value(0)));
+  case arrow::Type::INT32:
+  case arrow::Type::DATE32:
+  case arrow::Type::TIME32:
+    return InRange<parquet::Int32Statistics>(*stats, probe.data()->GetValues<int32_t>(1)[0]);
+  case arrow::Type::INT64:
+  case arrow::Type::TIMESTAMP:
+  case arrow::Type::TIME64:
+    return InRange<parquet::Int64Statistics>(*stats, probe.data()->GetValues<int64_t>(1)[0]);
+  case arrow::Type::FLOAT:
+    return InRange<parquet::FloatStatistics>(*stats, static_cast<const arrow::FloatArray&>(probe).Value(0));
+  case arrow::Type::DOUBLE:
+    return InRange<parquet::DoubleStatistics>(*stats, static_cast<const arrow::DoubleArray&>(probe).Value(0));
+  case arrow::Type::STRING:
+  case arrow::Type::BINARY:
+    return BytesInRange(*stats, static_cast<const arrow::BinaryArray&>(probe).GetView(0));
+  default:
+    return true;
+  }
+}
+
+/**
+ * Whether a row group's bloom filter admits the probe value. Filters hash
+ * the physical value, so narrow integers go through int32 like the writer.
+ */
+static bool BloomFilterMayContain(const parquet::BloomFilter& filter, const arrow::Array& probe) {
+  switch (probe.type_id()) {
+  case arrow::Type::INT8:
+    return filter.FindHash(filter.Hash(int32_t(static_cast<const arrow::Int8Array&>(probe).Value(0))));
+  case arrow::Type::UINT8:
+    return filter.FindHash(filter.Hash(int32_t(static_cast<const arrow::UInt8Array&>(probe).Value(0))));
+  case arrow::Type::INT16:
+    return filter.FindHash(filter.Hash(int32_t(static_cast<const arrow::Int16Array&>(probe).Value(0))));
+  case arrow::Type::UINT16:
+    return filter.FindHash(filter.Hash(int32_t(static_cast<const arrow::UInt16Array&>(probe).Value(0))));
+  case arrow::Type::INT32:
+  case arrow::Type::UINT32:
+  case arrow::Type::DATE32:
+  case arrow::Type::TIME32:
+    return filter.FindHash(filter.Hash(probe.data()->GetValues<int32_t>(1)[0]));
+  case arrow::Type::INT64:
+  case arrow::Type::UINT64:
+  case arrow::Type::TIMESTAMP:
+  case arrow::Type::TIME64:
+    return filter.FindHash(filter.Hash(probe.data()->GetValues<int64_t>(1)[0]));
+  case arrow::Type::FLOAT: {
+    // -0.0 and 0.0 are equal but hash differently
+    auto value = static_cast<const arrow::FloatArray&>(probe).Value(0);
+    return value == 0 || filter.FindHash(filter.Hash(value));
+  }
+  case arrow::Type::DOUBLE: {
+    auto value = static_cast<const arrow::DoubleArray&>(probe).Value(0);
+    return value == 0 || filter.FindHash(filter.Hash(value));
+  }
+  case arrow::Type::STRING:
+  case arrow::Type::BINARY: {
+    auto view = static_cast<const arrow::BinaryArray&>(probe).GetView(0);
+    parquet::ByteArray value(view.size(), reinterpret_cast<const uint8_t*>(view.data()));
+    return filter.FindHash(filter.Hash(&value));
+  }
+  case arrow::Type::FIXED_SIZE_BINARY: {
+    auto& fixed = static_cast<const arrow::FixedSizeBinaryArray&>(probe);
+    parquet::FLBA value(fixed.GetValue(0));
+    return filter.FindHash(filter.Hash(&value, fixed.byte_width()));
+  }
+  default:
+    return true;
+  }
+}
+
+/** Whether value is an integer JS number within [min, max] */
+inline static bool IsIntegerInRange(const Napi::Value& value, double min, double max) {
+  auto number = value.As<Napi::Number>().DoubleValue();
+  return std::trunc(number) == number && number >= min && number <= max;
+}
+
+template <typename T>
+inline static bool IsIntegerInRange(const Napi::Value& value) {
+  return IsIntegerInRange(value, double(std::numeric_limits<T>::min()), double(std::numeric_limits<T>::max()));
+}
+
+/**
+ * Converts a findRows value to a one-element array of the field's type.
+ * Null and undefined, and numbers no row of the column can hold, become a
+ * null probe that matches nothing. A value of the wrong JS type throws
+ * std::invalid_argument rather than being coerced.
+ */
+static ArrowArrayPtr MakeProbe(const ArrowFieldPtr& field, const Napi::Value& value) {
+  auto type = field->type();
+  auto nullProbe = [&type]() {
+    auto result = arrow::MakeArrayOfNull(type, 1);
+    if (!result.ok())
+      throw std::runtime_error(result.status().ToString());
+    return *result;
+  };
+
+  if (value.IsNull() || value.IsUndefined())
+    return nullProbe();
+
+  auto expected = "";
+  auto inRange = true;
+  switch (type->id()) {
+  case arrow::Type::BOOL:
+    expected = value.IsBoolean() ? "" : "boolean";
+    break;
+
+  case arrow::Type::UINT8:
+  case arrow::Type::INT8:
+  case arrow::Type::UINT16:
+  case arrow::Type::INT16:
+  case arrow::Type::UINT32:
+  case arrow::Type::INT32:
+  case arrow::Type::DATE32:
+  case arrow::Type::TIME32:
+    if (!value.IsNumber()) {
+      expected = "number";
+      break;
+    }
+    switch (type->id()) {
+    case arrow::Type::UINT8:  inRange = IsIntegerInRange<uint8_t>(value); break;
+    case arrow::Type::INT8:   inRange = IsIntegerInRange<int8_t>(value); break;
+    case arrow::Type::UINT16: inRange = IsIntegerInRange<uint16_t>(value); break;
+    case arrow::Type::INT16:  inRange = IsIntegerInRange<int16_t>(value); break;
+    case arrow::Type::UINT32: inRange = IsIntegerInRange<uint32_t>(value); break;
+    default:                  inRange = IsIntegerInRange<int32_t>(value); break;
+    }
+    break;
+
+  case arrow::Type::UINT64:
+  case arrow::Type::INT64:
+  case arrow::Type::TIMESTAMP:
+  case arrow::Type::TIME64:
+    if (value.IsBigInt()) {
+      auto lossless = true;
+      if (type->id() == arrow::Type::UINT64)
+        value.As<Napi::BigInt>().Uint64Value(&lossless);
+      else
+        value.As<Napi::BigInt>().Int64Value(&lossless);
+      inRange = lossless;
+    } else if (value.IsNumber()) {
+      // 2^63 itself is the first double past the int64 range
+      inRange = type->id() == arrow::Type::UINT64
+        ? IsIntegerInRange(value, 0, 18446744073709549568.0)
+        : IsIntegerInRange(value, -9223372036854775808.0, 9223372036854774784.0);
+    } else {
+      expected = "number or bigint";
+    }
+    break;
+
+  case arrow::Type::FLOAT:
+  case arrow::Type::DOUBLE:
+    expected = value.IsNumber() ? "" : "number";
+    break;
+
+  case arrow::Type::STRING:
+    expected = value.IsString() ? "" : "string";
+    break;
+
+  case arrow::Type::BINARY:
+  case arrow::Type::FIXED_SIZE_BINARY:
+    expected = value.IsBuffer() ? "" : "Buffer";
+    if (value.IsBuffer() && type->id() == arrow::Type::FIXED_SIZE_BINARY) {
+      auto width = static_cast<const arrow::FixedSizeBinaryType&>(*type).byte_width();
+      inRange = value.As<Napi::Buffer<uint8_t>>().Length() == static_cast<size_t>(width);
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  if (*expected)
+    throw std::invalid_argument("Column " + field->name() + " expects a " + expected + " value");
+  if (!inRange)
+    return nullProbe();
+
+  auto schema = arrow::schema({field});
+  auto columns = MakeColumns(schema);
+  auto row = Napi::Array::New(value.Env(), 1);
+  row.Set(uint32_t(0), value);
+  AppendRow(columns, row);
+  return FinishColumns(schema, columns)->column(0)->chunk(0);
+}
+
 class ParquetReader : public Napi::ObjectWrap<ParquetReader> {
 public:
   std::string _filepath;
   arrow::MemoryPool* _pool;
   shared_ptr<arrow::io::RandomAccessFile> _input;
   unique_ptr<parquet::arrow::FileReader> _reader;
+  // Columns are decoded on first use, null until then
   vector<ArrowColumnPtr> _columns;
   vector<vector<ArrowArrayPtr>> _chunksByColumn;
   vector<ArrowFieldPtr> _fieldByColumn;
+  vector<int64_t> _rowGroupOffsets;
+  vector<vector<shared_ptr<parquet::Statistics>>> _statisticsByRowGroup;
+  // Bloom filters by (row group, column), null when the writer didn't emit one
+  std::map<std::pair<int, int>, unique_ptr<parquet::BloomFilter>> _bloomFilters;
+  unique_ptr<KeyIndex> _keyIndex;
+  bool _keyIndexLoaded;
   int64_t _columnCount;
   int64_t _rowCount;
   bool _isOpen;
@@ -49,6 +280,9 @@ public:
           InstanceMethod("close",          &ParquetReader::Close),
           InstanceMethod("readRow",        &ParquetReader::ReadRow),
           InstanceMethod("readRowAsArray", &ParquetReader::ReadRowAsArray),
+          InstanceMethod("findRows",       &ParquetReader::FindRows),
+          InstanceMethod("getSortingColumns", &ParquetReader::GetSortingColumns),
+          InstanceMethod("readArrowIPC",   &ParquetReader::ReadArrowIPC),
         });
 
     auto constructor = new Napi::FunctionReference();
@@ -64,6 +298,7 @@ public:
     : Napi::ObjectWrap<ParquetReader>(info)
     , _pool(arrow::default_memory_pool())
     , _columns()
+    , _keyIndexLoaded(false)
     , _columnCount(0)
     , _rowCount(0)
     , _isOpen(false)
@@ -105,22 +340,24 @@ public:
       JS_ERROR(std::string("Failed to read schema: " + status.ToString()));
     }
 
-    status = _reader->ScanContents({}, 256, &_rowCount);
-    if (!status.ok()) {
-      JS_ERROR(std::string("Failed to read row count: ") + status.ToString());
-    }
-
+    // Only the footer is read here, column data is decoded when first needed
     _columnCount = schema->num_fields();
-
-    for (auto i = 0; i < _columnCount; i++) {
-      ArrowColumnPtr column;
-      status = _reader->ReadColumn(i, &column);
-      if (!status.ok()) {
-        JS_ERROR(std::string("Failed to read column: ") + status.ToString());
-      }
-      _columns.push_back(column);
-      _chunksByColumn.push_back(column->chunks());
+    _columns.resize(_columnCount);
+    _chunksByColumn.resize(_columnCount);
+    for (auto i = 0; i < _columnCount; i++)
       _fieldByColumn.push_back(schema->field(i));
+
+    auto metadata = _reader->parquet_reader()->metadata();
+    _rowCount = metadata->num_rows();
+    _rowGroupOffsets.push_back(0);
+    for (auto i = 0; i < metadata->num_row_groups(); i++) {
+      auto rowGroup = metadata->RowGroup(i);
+      _rowGroupOffsets.push_back(_rowGroupOffsets.back() + rowGroup->num_rows());
+
+      vector<shared_ptr<parquet::Statistics>> statistics;
+      for (auto c = 0; c < _columnCount; c++)
+        statistics.push_back(rowGroup->ColumnChunk(c)->statistics());
+      _statisticsByRowGroup.push_back(statistics);
     }
 
     return Napi::Boolean::New(env, _isOpen);
@@ -185,6 +422,12 @@ public:
       return env.Null();
     }
 
+    try {
+      DecodeAllColumns();
+    } catch (const std::runtime_error& e) {
+      JS_ERROR(e.what());
+    }
+
     auto rowIndex = info[0].As<Napi::Number>().Int64Value();
     auto results = Napi::Object::New(env);
 
@@ -208,6 +451,12 @@ public:
       return env.Null();
     }
 
+    try {
+      DecodeAllColumns();
+    } catch (const std::runtime_error& e) {
+      JS_ERROR(e.what());
+    }
+
     auto rowIndex = info[0].As<Napi::Number>().Int64Value();
     auto results = Napi::Array::New(env, _columnCount);
 
@@ -218,6 +467,184 @@ public:
     return results;
   }
 
+  /**
+   * Returns the sorted indices of the rows where column equals value (or any
+   * of values). Uses the sidecar key index when the column has one, otherwise
+   * only scans the row groups whose statistics can contain a match.
+   */
+  Napi::Value FindRows(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!_isOpen) {
+      JS_ERROR("File is not open");
+    }
+
+    if (info.Length() < 2 || !info[0].IsString()) {
+      Napi::TypeError::New(env, "column:string, value|values[] expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    auto name = info[0].As<Napi::String>().Utf8Value();
+    auto columnIndex = -1;
+    for (auto i = 0; i < _columnCount; i++) {
+      if (_fieldByColumn[i]->name() == name)
+        columnIndex = i;
+    }
+    if (columnIndex < 0) {
+      JS_ERROR("Unknown column: " + name);
+    }
+
+    // Null probes are kept so the conversion is checked, but match nothing
+    vector<ArrowArrayPtr> probes;
+    try {
+      if (info[1].IsArray()) {
+        auto values = info[1].As<Napi::Array>();
+        for (uint32_t i = 0; i < values.Length(); i++)
+          probes.push_back(MakeProbe(_fieldByColumn[columnIndex], values.Get(i)));
+      } else {
+        probes.push_back(MakeProbe(_fieldByColumn[columnIndex], info[1]));
+      }
+    } catch (const std::invalid_argument& e) {
+      Napi::TypeError::New(env, e.what()).ThrowAsJavaScriptException();
+      return env.Null();
+    } catch (const std::runtime_error& e) {
+      JS_ERROR(e.what());
+    }
+
+    ProbesByHash probesByHash;
+    for (const auto& probe : probes) {
+      if (!probe->IsNull(0))
+        probesByHash[HashArrayValue(*probe, 0)].push_back(probe.get());
+    }
+
+    vector<int64_t> rows;
+    try {
+      auto keyIndex = GetKeyIndex();
+      if (keyIndex && keyIndex->HasColumn(name))
+        FindRowsWithIndex(*keyIndex, columnIndex, probesByHash, rows);
+      else
+        FindRowsWithStatistics(columnIndex, probes, probesByHash, rows);
+    } catch (const std::exception& e) {
+      JS_ERROR(e.what());
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    auto results = Napi::Array::New(env, rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+      results[i] = Napi::Number::New(env, rows[i]);
+    }
+
+    return results;
+  }
+
+  /**
+   * Returns the `[{ column, order }]` sort order shared by every row group,
+   * or an empty array when the row groups don't record one.
+   */
+  Napi::Value GetSortingColumns(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!_isOpen) {
+      JS_ERROR("File is not open");
+    }
+
+    auto same = [](const parquet::SortingColumn& a, const parquet::SortingColumn& b) {
+      return a.column_idx == b.column_idx && a.descending == b.descending && a.nulls_first == b.nulls_first;
+    };
+
+    auto metadata = _reader->parquet_reader()->metadata();
+    vector<parquet::SortingColumn> sortingColumns;
+    for (auto rg = 0; rg < metadata->num_row_groups(); rg++) {
+      auto current = metadata->RowGroup(rg)->sorting_columns();
+      auto matches = current.size() == sortingColumns.size()
+        && std::equal(current.begin(), current.end(), sortingColumns.begin(), same);
+      if (rg > 0 && !matches) {
+        sortingColumns.clear();
+        break;
+      }
+      sortingColumns = current;
+    }
+
+    for (const auto& i : sortingColumns) {
+      if (i.column_idx < 0 || i.column_idx >= _columnCount)
+        return Napi::Array::New(env, 0);
+    }
+
+    auto results = Napi::Array::New(env, sortingColumns.size());
+    for (size_t i = 0; i < sortingColumns.size(); i++) {
+      auto column = Napi::Object::New(env);
+      column.Set("column", _fieldByColumn[sortingColumns[i].column_idx]->name());
+      column.Set("order", sortingColumns[i].descending ? "desc" : "asc");
+      results[i] = column;
+    }
+
+    return results;
+  }
+
+  /**
+   * Returns rows [start, end) of the given columns (all when null) as an
+   * Arrow IPC stream. The decoded chunks are sliced, not converted, then
+   * serialized into one new buffer that JS receives without a further copy.
+   */
+  Napi::Value ReadArrowIPC(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!_isOpen) {
+      JS_ERROR("File is not open");
+    }
+
+    vector<int> columnIndices;
+
+    if (info.Length() > 0 && info[0].IsArray()) {
+      auto names = info[0].As<Napi::Array>();
+      for (uint32_t i = 0; i < names.Length(); i++) {
+        auto name = names.Get(i).ToString().Utf8Value();
+        auto columnIndex = -1;
+        for (auto c = 0; c < _columnCount; c++) {
+          if (_fieldByColumn[c]->name() == name)
+            columnIndex = c;
+        }
+        if (columnIndex < 0) {
+          JS_ERROR("Unknown column: " + name);
+        }
+        columnIndices.push_back(columnIndex);
+      }
+    } else {
+      for (auto c = 0; c < _columnCount; c++)
+        columnIndices.push_back(c);
+    }
+
+    arrow::FieldVector fields;
+    vector<ArrowColumnPtr> columns;
+    try {
+      for (auto c : columnIndices) {
+        DecodeColumn(c);
+        fields.push_back(_fieldByColumn[c]);
+        columns.push_back(_columns[c]);
+      }
+    } catch (const std::runtime_error& e) {
+      JS_ERROR(e.what());
+    }
+
+    int64_t start = 0;
+    int64_t end = _rowCount;
+    if (info.Length() > 1 && info[1].IsNumber())
+      start = std::max(info[1].As<Napi::Number>().Int64Value(), int64_t(0));
+    if (info.Length() > 2 && info[2].IsNumber())
+      end = std::min(info[2].As<Napi::Number>().Int64Value(), _rowCount);
+    end = std::max(start, end);
+
+    auto table = arrow::Table::Make(arrow::schema(fields), columns, _rowCount)->Slice(start, end - start);
+
+    try {
+      return NapiBufferFromArrow(env, TableToIPC(*table));
+    } catch (const std::runtime_error& e) {
+      JS_ERROR(e.what());
+    }
+  }
+
   Napi::Value ReadValue(const Napi::CallbackInfo& info, int columnIndex, int rowIndex) {
     Napi::Env env = info.Env();
 
@@ -284,6 +711,149 @@ public:
     return env.Null();
   }
 
+protected:
+  typedef std::unordered_map<uint64_t, vector<const arrow::Array*>> ProbesByHash;
+
+  /** Decodes every chunk of column i on first use */
+  void DecodeColumn(int i) {
+    if (_columns[i])
+      return;
+
+    ArrowColumnPtr column;
+    auto status = _reader->ReadColumn(i, &column);
+    if (!status.ok())
+      throw std::runtime_error("Failed to read column: " + status.ToString());
+    _chunksByColumn[i] = column->chunks();
+    _columns[i] = column;
+  }
+
+  void DecodeAllColumns() {
+    for (auto i = 0; i < _columnCount; i++)
+      DecodeColumn(i);
+  }
+
+  /**
+   * Column i of row group rg. Sliced from the decoded column when there is
+   * one, otherwise only that column chunk is read from the file.
+   */
+  ArrowColumnPtr ReadRowGroupColumn(int rg, int i) {
+    auto start = _rowGroupOffsets[rg];
+    if (_columns[i])
+      return _columns[i]->Slice(start, _rowGroupOffsets[rg + 1] - start);
+
+    ArrowColumnPtr column;
+    auto status = _reader->RowGroup(rg)->Column(i)->Read(&column);
+    if (!status.ok())
+      throw std::runtime_error("Failed to read column: " + status.ToString());
+    return column;
+  }
+
+  /** Bloom filter of column i in row group rg, loaded once; null when the file has none */
+  parquet::BloomFilter* GetBloomFilter(int rg, int i) {
+    auto key = std::make_pair(rg, i);
+    auto it = _bloomFilters.find(key);
+    if (it == _bloomFilters.end()) {
+      unique_ptr<parquet::BloomFilter> filter;
+      try {
+        auto rowGroup = _reader->parquet_reader()->GetBloomFilterReader().RowGroup(rg);
+        if (rowGroup)
+          filter = rowGroup->GetColumnBloomFilter(i);
+      } catch (const parquet::ParquetException&) {
+        // An unreadable filter only costs the pruning
+      }
+      it = _bloomFilters.emplace(key, std::move(filter)).first;
+    }
+    return it->second.get();
+  }
+
+  /** Loads the sidecar key index on first use; null if missing, stale or corrupt */
+  KeyIndex* GetKeyIndex() {
+    if (!_keyIndexLoaded) {
+      auto size = _input->GetSize();
+      if (size.ok())
+        _keyIndex = KeyIndex::Load(_filepath + KEY_INDEX_EXTENSION, _rowCount, *size);
+      _keyIndexLoaded = true;
+    }
+    return _keyIndex.get();
+  }
+
+  /** Checks the index's candidates, reading the column only for the row groups they fall in */
+  void FindRowsWithIndex(const KeyIndex& keyIndex, int columnIndex, const ProbesByHash& probesByHash,
+                         vector<int64_t>& rows) {
+    vector<std::pair<int64_t, const vector<const arrow::Array*>*>> candidates;
+    vector<int64_t> candidateRows;
+    for (const auto& it : probesByHash) {
+      candidateRows.clear();
+      keyIndex.FindCandidates(_fieldByColumn[columnIndex]->name(), it.first, candidateRows);
+      for (auto row : candidateRows) {
+        if (row < _rowCount)
+          candidates.emplace_back(row, &it.second);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // Hashes can collide, so check the actual values
+    auto rg = -1;
+    ArrowColumnPtr column;
+    vector<int64_t> chunkOffsets;
+    for (const auto& candidate : candidates) {
+      auto row = candidate.first;
+      if (rg < 0 || row >= _rowGroupOffsets[rg + 1]) {
+        rg = std::upper_bound(_rowGroupOffsets.begin(), _rowGroupOffsets.end(), row) - _rowGroupOffsets.begin() - 1;
+        column = ReadRowGroupColumn(rg, columnIndex);
+        chunkOffsets = { _rowGroupOffsets[rg] };
+        for (const auto& chunk : column->chunks())
+          chunkOffsets.push_back(chunkOffsets.back() + chunk->length());
+      }
+
+      auto c = std::upper_bound(chunkOffsets.begin(), chunkOffsets.end(), row) - chunkOffsets.begin() - 1;
+      if (MatchesAny(*column->chunk(c), row - chunkOffsets[c], *candidate.second))
+        rows.push_back(row);
+    }
+  }
+
+  /**
+   * Reads the column only for the row groups whose statistics and bloom
+   * filter admit a probe, then scans them once for all probes.
+   */
+  void FindRowsWithStatistics(int columnIndex, const vector<ArrowArrayPtr>& probes, const ProbesByHash& probesByHash,
+                              vector<int64_t>& rows) {
+    if (probesByHash.empty())
+      return;
+
+    for (size_t rg = 0; rg < _statisticsByRowGroup.size(); rg++) {
+      auto& stats = _statisticsByRowGroup[rg][columnIndex];
+      auto filter = GetBloomFilter(rg, columnIndex);
+      auto mayMatch = std::any_of(probes.begin(), probes.end(), [&](const ArrowArrayPtr& probe) {
+        return !probe->IsNull(0) && StatisticsMayContain(stats, *probe)
+          && (!filter || BloomFilterMayContain(*filter, *probe));
+      });
+      if (!mayMatch)
+        continue;
+
+      auto row = _rowGroupOffsets[rg];
+      for (const auto& chunk : ReadRowGroupColumn(rg, columnIndex)->chunks()) {
+        for (int64_t index = 0; index < chunk->length(); index++, row++) {
+          if (chunk->IsNull(index))
+            continue;
+          auto it = probesByHash.find(HashArrayValue(*chunk, index));
+          if (it != probesByHash.end() && MatchesAny(*chunk, index, it->second))
+            rows.push_back(row);
+        }
+      }
+    }
+  }
+
+  static bool MatchesAny(const arrow::Array& chunk, int64_t index, const vector<const arrow::Array*>& probes) {
+    if (chunk.IsNull(index))
+      return false;
+    for (auto probe : probes) {
+      if (chunk.RangeEquals(index, index + 1, 0, *probe))
+        return true;
+    }
+    return false;
+  }
+
 };
 
 #endif
@@ -4,11 +4,19 @@
 #include <napi.h>
 
 #include <arrow/builder.h>
+#include <arrow/compute/api.h>
+#include <arrow/util/parallel.h>
+#include <arrow/util/thread_pool.h>
 #include <parquet/arrow/writer.h>
 #include <parquet/properties.h>
 
+#include <cstdio>
+#include <filesystem>
 #include <vector>
 
+#include "arrow_ipc.h"
+#include "key_index.h"
+
 inline static ArrowFieldPtr MakeField(const std::string& name, std::shared_ptr<arrow::DataType> type) {
   return std::make_shared<arrow::Field>(name, type);
 }
@@ -117,11 +125,221 @@ void AppendScalar<std::shared_ptr<arrow::Buffer>>(Column& column, const std::sha
   }
 }
 
+/** Builds the arrow schema described by a JS schema object */
+static ArrowSchemaPtr BuildSchema(const Napi::Object& jsSchema) {
+  auto keys = jsSchema.GetPropertyNames();
+  arrow::FieldVector fields;
+  for (uint32_t i = 0; i < keys.Length(); i++) {
+    auto name = keys.Get(i).ToString().Utf8Value();
+    auto fieldObj = jsSchema.Get(name).ToObject();
+    auto type = static_cast<arrow::Type::type>(fieldObj.Get("type").ToNumber().Int32Value());
+    fields.push_back(NapiObjToArrowField(name, fieldObj, type));
+  }
+  return arrow::schema(fields);
+}
+
+/** Creates one empty builder per field of the schema */
+static std::vector<Column> MakeColumns(const ArrowSchemaPtr& schema) {
+  std::vector<Column> columns;
+  for (const auto& field : schema->fields()) {
+    std::unique_ptr<arrow::ArrayBuilder> builder;
+    auto status = arrow::MakeBuilder(arrow::default_memory_pool(), field->type(), &builder);
+    if (!status.ok()) {
+      throw std::runtime_error(status.ToString());
+    }
+    columns.push_back(Column{field->name(), field->type()->id(), std::move(builder)});
+  }
+  return columns;
+}
+
+/** Finishes every builder into a table; builders are reset and can be reused */
+static std::shared_ptr<arrow::Table> FinishColumns(const ArrowSchemaPtr& schema, std::vector<Column>& columns) {
+  arrow::ArrayVector arrays;
+  for (auto& i : columns) {
+    ArrowArrayPtr out;
+    i.builder->Finish(&out);
+    arrays.push_back(out);
+  }
+  return arrow::Table::Make(schema, arrays);
+}
+
+static void AppendRow(std::vector<Column>& columns, const Napi::Array& row) {
+  if (columns.size() != row.Length()) {
+    throw std::runtime_error("Number of columns does not match schema");
+  }
+
+  for (size_t i = 0; i < columns.size(); i++) {
+    switch (columns[i].type) {
+    case arrow::Type::type::BOOL:
+      AppendScalar(columns[i], row.Get(i).ToBoolean().Value());
+      break;
+
+    case arrow::Type::type::UINT8:
+      AppendScalar(columns[i], static_cast<uint8_t>(row.Get(i).ToNumber().Uint32Value()));
+      break;
+
+    case arrow::Type::type::INT8:
+      AppendScalar(columns[i], static_cast<int8_t>(row.Get(i).ToNumber().Uint32Value()));
+      break;
+
+    case arrow::Type::type::UINT16:
+      AppendScalar(columns[i], static_cast<uint16_t>(row.Get(i).ToNumber().Uint32Value()));
+      break;
+
+    case arrow::Type::type::INT16:
+      AppendScalar(columns[i], static_cast<int16_t>(row.Get(i).ToNumber().Uint32Value()));
+      break;
+
+    case arrow::Type::type::UINT32:
+      AppendScalar(columns[i], row.Get(i).ToNumber().Uint32Value());
+      break;
+
+    case arrow::Type::type::INT32:
+    case arrow::Type::type::DATE32:
+    case arrow::Type::type::TIME32:
+      AppendScalar(columns[i], row.Get(i).ToNumber().Int32Value());
+      break;
+
+    case arrow::Type::type::UINT64: {
+      auto value = row.Get(i);
+      auto lossless = true;
+      if (value.IsBigInt()) {
+        AppendScalar(columns[i], value.As<Napi::BigInt>().Uint64Value(&lossless));
+      } else {
+        AppendScalar(columns[i], static_cast<uint64_t>(value.ToNumber().Int64Value()));
+      }
+      break;
+    }
+
+    case arrow::Type::type::INT64:
+    case arrow::Type::type::TIMESTAMP:
+    case arrow::Type::type::TIME64: {
+      auto value = row.Get(i);
+      auto lossless = true;
+      if (value.IsBigInt()) {
+        AppendScalar(columns[i], value.As<Napi::BigInt>().Int64Value(&lossless));
+      } else {
+        AppendScalar(columns[i], value.ToNumber().Int64Value());
+      }
+      break;
+    }
+
+    case arrow::Type::type::FLOAT:
+      AppendScalar(columns[i], row.Get(i).ToNumber().FloatValue());
+      break;
+
+    case arrow::Type::type::DOUBLE:
+      AppendScalar(columns[i], row.Get(i).ToNumber().DoubleValue());
+      break;
+
+    case arrow::Type::type::STRING:
+      AppendScalar(columns[i], row.Get(i).ToString().Utf8Value());
+      break;
+
+    case arrow::Type::type::BINARY:
+    case arrow::Type::type::FIXED_SIZE_BINARY: {
+      arrow::BufferBuilder arrowBuf;
+      auto napiBuf = row.Get(i).As<Napi::Buffer<uint8_t>>();
+      arrowBuf.Append(napiBuf.Data(), napiBuf.Length());
+      std::shared_ptr<arrow::Buffer> finalBuf;
+      arrowBuf.Finish(&finalBuf);
+      AppendScalar(columns[i], finalBuf);
+      break;
+    }
+
+    default:
+      // Should only happen if a JS user isn't using the enum
+      throw std::runtime_error("Data type not supported");
+    }
+  }
+}
+
+struct SortColumn {
+  std::string column;
+  arrow::compute::SortOrder order;
+};
+
+/** Parses a JS `[{ column, order }]` array, order being 'asc' (default) or 'desc' */
+static std::vector<SortColumn> ParseSortBy(const ArrowSchemaPtr& schema, const Napi::Array& sortBy) {
+  std::vector<SortColumn> result;
+  for (uint32_t i = 0; i < sortBy.Length(); i++) {
+    auto key = sortBy.Get(i).ToObject();
+    auto column = key.Get("column").ToString().Utf8Value();
+    if (schema->GetFieldIndex(column) < 0) {
+      throw std::runtime_error("Unknown sort column: " + column);
+    }
+
+    auto order = arrow::compute::SortOrder::Ascending;
+    if (key.Has("order")) {
+      auto name = key.Get("order").ToString().Utf8Value();
+      if (name == "desc" || name == "descending") {
+        order = arrow::compute::SortOrder::Descending;
+      } else if (name != "asc" && name != "ascending") {
+        throw std::runtime_error("Invalid sort order: " + name);
+      }
+    }
+    result.push_back(SortColumn{column, order});
+  }
+  return result;
+}
+
+/**
+ * Describes sortBy as Parquet sorting columns, which the writer stores in
+ * the metadata of every row group. Nulls are sorted last, as SortIndices does.
+ */
+static std::vector<parquet::SortingColumn> ToSortingColumns(const ArrowSchemaPtr& schema, const std::vector<SortColumn>& sortBy) {
+  std::vector<parquet::SortingColumn> result;
+  for (const auto& i : sortBy) {
+    parquet::SortingColumn column;
+    column.column_idx = schema->GetFieldIndex(i.column);
+    column.descending = i.order == arrow::compute::SortOrder::Descending;
+    column.nulls_first = false;
+    result.push_back(column);
+  }
+  return result;
+}
+
+/**
+ * Reorders the rows of table by sortBy. The columns are gathered in parallel
+ * on arrow's CPU thread pool, which is bounded process-wide, so the dataset
+ * writer's workers share it rather than each adding threads.
+ */
+static std::shared_ptr<arrow::Table> SortTable(const std::shared_ptr<arrow::Table>& table, const std::vector<SortColumn>& sortBy) {
+  if (sortBy.empty() || table->num_rows() < 2)
+    return table;
+
+  std::vector<arrow::compute::SortKey> keys;
+  for (const auto& i : sortBy) {
+    keys.emplace_back(i.column, i.order);
+  }
+
+  auto indices = arrow::compute::SortIndices(arrow::Datum(table), arrow::compute::SortOptions(keys));
+  if (!indices.ok()) {
+    throw std::runtime_error(indices.status().ToString());
+  }
+  auto numColumns = table->num_columns();
+  std::vector<ArrowColumnPtr> columns(numColumns);
+  auto status = arrow::internal::ParallelFor(numColumns, [&](int i) -> arrow::Status {
+    ARROW_ASSIGN_OR_RAISE(auto column, arrow::compute::Take(arrow::Datum(table->column(i)), arrow::Datum(*indices)));
+    columns[i] = column.chunked_array();
+    return arrow::Status::OK();
+  }, arrow::internal::GetCpuThreadPool());
+  if (!status.ok()) {
+    throw std::runtime_error(status.ToString());
+  }
+  return arrow::Table::Make(table->schema(), columns, table->num_rows());
+}
+
 class ParquetWriter : public Napi::ObjectWrap<ParquetWriter> {
 protected:
   std::string filepath;
   ArrowSchemaPtr schema;
   std::vector<Column> columns;
+  std::vector<int> indexColumns;
+  std::vector<SortColumn> sortBy;
+  // Rows finished ahead of close(), in order: appended rows flushed from the
+  // builders and tables ingested from IPC streams
+  std::vector<std::shared_ptr<arrow::Table>> pending;
   std::shared_ptr<arrow::io::FileOutputStream> outfile;
   parquet::WriterProperties::Builder propBuilder;
 
@@ -131,9 +349,12 @@ public:
       DefineClass(env,
         "ParquetWriter", {
           InstanceMethod("appendRowArray",       &ParquetWriter::AppendRowArray),
+          InstanceMethod("writeArrowIPC",        &ParquetWriter::WriteArrowIPC),
           InstanceMethod("open",                 &ParquetWriter::Open),
           InstanceMethod("close",                &ParquetWriter::Close),
           InstanceMethod("setRowGroupSize",      &ParquetWriter::SetRowGroupSize),
+          InstanceMethod("setIndexColumns",      &ParquetWriter::SetIndexColumns),
+          InstanceMethod("setSortBy",            &ParquetWriter::SetSortBy),
         });
 
     auto constructor = new Napi::FunctionReference();
@@ -156,136 +377,79 @@ public:
 
     filepath = info[1].ToString().Utf8Value();
 
-    // Build schema
-    auto jsSchema = info[0].As<Napi::Object>();
-    auto keys = jsSchema.GetPropertyNames();
-    arrow::FieldVector fields;
-    for (uint32_t i = 0; i < keys.Length(); i++) {
-      auto name = keys.Get(i).ToString().Utf8Value();
-      auto fieldObj = jsSchema.Get(name).ToObject();
-      auto type = static_cast<arrow::Type::type>(fieldObj.Get("type").ToNumber().Int32Value());
-
-      try {
-        fields.push_back(NapiObjToArrowField(name, fieldObj, type));
-      } catch (const std::runtime_error& e) {
-        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-        return;
-      }
-
-      std::unique_ptr<arrow::ArrayBuilder> builder;
-
-      try {
-        PARQUET_THROW_NOT_OK(arrow::MakeBuilder(arrow::default_memory_pool(), fields.back()->type(), &builder));
-      } catch (const parquet::ParquetException& e) {
-        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
-        return;
-      }
-      columns.push_back(Column{std::move(name), type, std::move(builder)});
+    try {
+      schema = BuildSchema(info[0].As<Napi::Object>());
+      columns = MakeColumns(schema);
+    } catch (const std::runtime_error& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+      return;
     }
-
-    schema = arrow::schema(fields);
   }
 
-  void AppendRow(const Napi::Array& row) {
-    if (columns.size() != row.Length()) {
-      throw std::runtime_error("Number of columns does not match schema");
+  Napi::Value AppendRowArray(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+      Napi::TypeError::New(env, "row:Array expected").ThrowAsJavaScriptException();
+      return env.Undefined();
     }
 
-    for (size_t i = 0; i < columns.size(); i++) {
-      switch (columns[i].type) {
-      case arrow::Type::type::BOOL:
-        AppendScalar(columns[i], row.Get(i).ToBoolean().Value());
-        break;
-
-      case arrow::Type::type::UINT8:
-        AppendScalar(columns[i], static_cast<uint8_t>(row.Get(i).ToNumber().Uint32Value()));
-        break;
-
-      case arrow::Type::type::INT8:
-        AppendScalar(columns[i], static_cast<int8_t>(row.Get(i).ToNumber().Uint32Value()));
-        break;
-
-      case arrow::Type::type::UINT16:
-        AppendScalar(columns[i], static_cast<uint16_t>(row.Get(i).ToNumber().Uint32Value()));
-        break;
-
-      case arrow::Type::type::INT16:
-        AppendScalar(columns[i], static_cast<int16_t>(row.Get(i).ToNumber().Uint32Value()));
-        break;
-
-      case arrow::Type::type::UINT32:
-        AppendScalar(columns[i], row.Get(i).ToNumber().Uint32Value());
-        break;
-
-      case arrow::Type::type::INT32:
-      case arrow::Type::type::DATE32:
-      case arrow::Type::type::TIME32:
-        AppendScalar(columns[i], row.Get(i).ToNumber().Int32Value());
-        break;
-
-      case arrow::Type::type::UINT64: {
-        auto value = row.Get(i);
-        auto lossless = true;
-        if (value.IsBigInt()) {
-          AppendScalar(columns[i], value.As<Napi::BigInt>().Uint64Value(&lossless));
-        } else {
-          AppendScalar(columns[i], static_cast<uint64_t>(value.ToNumber().Int64Value()));
-        }
-        break;
-      }
-
-      case arrow::Type::type::INT64:
-      case arrow::Type::type::TIMESTAMP:
-      case arrow::Type::type::TIME64: {
-        auto value = row.Get(i);
-        auto lossless = true;
-        if (value.IsBigInt()) {
-          AppendScalar(columns[i], value.As<Napi::BigInt>().Int64Value(&lossless));
-        } else {
-          AppendScalar(columns[i], value.ToNumber().Int64Value());
-        }
-        break;
-      }
-
-      case arrow::Type::type::FLOAT:
-        AppendScalar(columns[i], row.Get(i).ToNumber().FloatValue());
-        break;
-
-      case arrow::Type::type::DOUBLE:
-        AppendScalar(columns[i], row.Get(i).ToNumber().DoubleValue());
-        break;
-
-      case arrow::Type::type::STRING:
-        AppendScalar(columns[i], row.Get(i).ToString().Utf8Value());
-        break;
-
-      case arrow::Type::type::BINARY:
-      case arrow::Type::type::FIXED_SIZE_BINARY: {
-        arrow::BufferBuilder arrowBuf;
-        auto napiBuf = row.Get(i).As<Napi::Buffer<uint8_t>>();
-        arrowBuf.Append(napiBuf.Data(), napiBuf.Length());
-        std::shared_ptr<arrow::Buffer> finalBuf;
-        arrowBuf.Finish(&finalBuf);
-        AppendScalar(columns[i], finalBuf);
-        break;
-      }
-
-      default:
-        // Should only happen if a JS user isn't using the enum
-        throw std::runtime_error("Data type not supported");
-      }
+    try {
+      AppendRow(columns, info[0].As<Napi::Array>());
+    } catch (const std::runtime_error& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
     }
+
+    return env.Undefined();
   }
 
-  Napi::Value AppendRowArray(const Napi::CallbackInfo& info) {
+  /**
+   * Ingests the record batches of an IPC stream with the writer's column names,
+   * in order. Columns of another type are cast whole when arrow can (e.g. the
+   * dictionary-encoded strings apache-arrow produces, or float64 numbers).
+   */
+  Napi::Value WriteArrowIPC(const Napi::CallbackInfo& info) {
     auto env = info.Env();
-    if (info.Length() < 1 || !info[0].IsArray()) {
-      Napi::TypeError::New(env, "row:Array expected").ThrowAsJavaScriptException();
+    if (info.Length() < 1 || !info[0].IsBuffer()) {
+      Napi::TypeError::New(env, "buffer:Buffer expected").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
     try {
-      AppendRow(info[0].As<Napi::Array>());
+      // Rows are buffered until close(), so the batches need memory of their own
+      auto table = TableFromIPC(CopyNapiBuffer(info[0].As<Napi::Buffer<uint8_t>>()));
+
+      auto ipcSchema = table->schema();
+      if (ipcSchema->num_fields() != schema->num_fields()) {
+        throw std::runtime_error("Number of columns does not match schema");
+      }
+      std::vector<std::shared_ptr<arrow::ChunkedArray>> ipcColumns;
+      for (auto i = 0; i < schema->num_fields(); i++) {
+        auto expected = schema->field(i);
+        auto actual = ipcSchema->field(i);
+        auto mismatch =
+          "Column " + actual->name() + ": " + actual->type()->ToString() +
+          " does not match " + expected->name() + ": " + expected->type()->ToString();
+
+        if (expected->name() != actual->name()) {
+          throw std::runtime_error(mismatch);
+        }
+        if (expected->type()->Equals(actual->type())) {
+          ipcColumns.push_back(table->column(i));
+          continue;
+        }
+        auto cast = arrow::compute::Cast(arrow::Datum(table->column(i)), expected->type());
+        if (!cast.ok()) {
+          throw std::runtime_error(mismatch + ": " + cast.status().ToString());
+        }
+        ipcColumns.push_back(cast->chunked_array());
+      }
+
+      // Keep rows appended so far ahead of the ingested ones
+      if (columns.size() > 0 && columns[0].builder->length() > 0) {
+        pending.push_back(FinishColumns(schema, columns));
+      }
+      pending.push_back(arrow::Table::Make(schema, ipcColumns, table->num_rows()));
     } catch (const std::runtime_error& e) {
       Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
       return env.Undefined();
@@ -311,13 +475,21 @@ public:
 
   Napi::Value Close(const Napi::CallbackInfo& info) {
     auto env = info.Env();
-    arrow::ArrayVector arrays;
-    for (auto& i : columns) {
-      ArrowArrayPtr out;
-      i.builder->Finish(&out);
-      arrays.push_back(out);
+    std::shared_ptr<arrow::Table> table;
+
+    try {
+      pending.push_back(FinishColumns(schema, columns));
+      auto concatenated = arrow::ConcatenateTables(pending);
+      pending.clear();
+      if (!concatenated.ok()) {
+        throw std::runtime_error(concatenated.status().ToString());
+      }
+      table = arrow::Table::Make(schema, (*concatenated)->columns(), (*concatenated)->num_rows());
+      table = SortTable(table, sortBy);
+    } catch (const std::runtime_error& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
     }
-    auto table = arrow::Table::Make(schema, arrays);
 
     try {
       PARQUET_THROW_NOT_OK(
@@ -328,6 +500,19 @@ public:
     }
 
     outfile->Close();
+
+    // Always replace the sidecar, a stale one would hide rows from findRows
+    auto indexPath = filepath + KEY_INDEX_EXTENSION;
+    std::remove(indexPath.c_str());
+    if (!indexColumns.empty()) {
+      try {
+        WriteKeyIndex(indexPath, *table, indexColumns, std::filesystem::file_size(filepath));
+      } catch (const std::exception& e) {
+        Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    }
+
     return env.Undefined();
   }
 
@@ -342,6 +527,47 @@ public:
     return env.Undefined();
   }
 
+  Napi::Value SetIndexColumns(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+      Napi::TypeError::New(env, "columns:string[] expected").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto names = info[0].As<Napi::Array>();
+    std::vector<int> indices;
+    for (uint32_t i = 0; i < names.Length(); i++) {
+      auto name = names.Get(i).ToString().Utf8Value();
+      auto index = schema->GetFieldIndex(name);
+      if (index < 0) {
+        Napi::Error::New(env, "Unknown index column: " + name).ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      indices.push_back(index);
+    }
+
+    indexColumns = std::move(indices);
+    return env.Undefined();
+  }
+
+  Napi::Value SetSortBy(const Napi::CallbackInfo& info) {
+    auto env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+      Napi::TypeError::New(env, "sortBy:{ column, order }[] expected").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    try {
+      sortBy = ParseSortBy(schema, info[0].As<Napi::Array>());
+    } catch (const std::runtime_error& e) {
+      Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    propBuilder.set_sorting_columns(ToSortingColumns(schema, sortBy));
+    return env.Undefined();
+  }
+
 protected:
   
 
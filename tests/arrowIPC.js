@@ -0,0 +1,83 @@
+/*
+ * arrowIPC.js
+ */
+
+const assert = require('assert')
+const lib = require('../lib')
+const type = lib.type
+
+const schema = {
+  id: { type: type.INT64 },
+  name: { type: type.STRING },
+  value: { type: type.DOUBLE },
+}
+
+const rowCount = 1000
+
+const writer = new lib.ParquetWriter(schema, 'test-out-ipc.parquet')
+writer.open()
+for (let i = 0; i < rowCount; i++) {
+  writer.appendRow([i, 'name-' + i, i / 4])
+}
+writer.close()
+
+const reader = lib.ParquetReader.openFile('test-out-ipc.parquet')
+const stream = reader.readArrowIPC()
+assert.ok(Buffer.isBuffer(stream))
+
+// Round-trip: appended rows and ingested batches keep their order
+const copy = new lib.ParquetWriter(schema, 'test-out-ipc-copy.parquet')
+copy.open()
+copy.appendRow([-1, 'first', 0])
+copy.writeArrowIPC(stream)
+copy.writeArrowIPC(reader.readArrowIPC(null, [10, 20]))
+copy.close()
+reader.close()
+
+const copyReader = lib.ParquetReader.openFile('test-out-ipc-copy.parquet')
+assert.equal(copyReader.getRowCount(), 1 + rowCount + 10)
+assert.deepEqual(copyReader.readRow(0), { id: -1, name: 'first', value: 0 })
+assert.deepEqual(copyReader.readRow(1 + 123), { id: 123, name: 'name-123', value: 123 / 4 })
+assert.deepEqual(copyReader.readRow(1 + rowCount), { id: 10, name: 'name-10', value: 10 / 4 })
+copyReader.close()
+
+// Mismatched schemas are rejected
+const narrow = lib.ParquetReader.openFile('test-out-ipc.parquet')
+const other = new lib.ParquetWriter(schema, 'test-out-ipc-other.parquet')
+assert.throws(() => other.writeArrowIPC(narrow.readArrowIPC(['id'])))
+narrow.close()
+
+// Interop with the apache-arrow package. It isn't a dependency, so these
+// checks run only where it is installed (`npm install --no-save apache-arrow`)
+let arrow = null
+try {
+  arrow = require('apache-arrow')
+} catch (e) {
+  console.log('apache-arrow is not installed, skipping interop checks')
+}
+
+if (arrow) {
+  // apache-arrow encodes strings as dictionaries, they are cast natively
+  const jsTable = arrow.tableFromArrays({
+    id: BigInt64Array.from([1n, 2n, 3n]),
+    name: ['a', 'b', 'a'],
+    value: Float64Array.from([0.5, 1.5, 2.5]),
+  })
+  assert.ok(arrow.DataType.isDictionary(jsTable.schema.fields[1].type))
+
+  const fromJs = new lib.ParquetWriter(schema, 'test-out-ipc-js.parquet')
+  fromJs.open()
+  fromJs.writeArrowIPC(arrow.tableToIPC(jsTable, 'stream'))
+  fromJs.close()
+
+  const fromJsReader = lib.ParquetReader.openFile('test-out-ipc-js.parquet')
+  assert.equal(fromJsReader.getRowCount(), 3)
+  assert.deepEqual(fromJsReader.readRow(2), { id: 3, name: 'a', value: 2.5 })
+  fromJsReader.close()
+
+  // And streams read back into apache-arrow as tables
+  const ipcReader = lib.ParquetReader.openFile('test-out-ipc-js.parquet')
+  const readBack = arrow.tableFromIPC(ipcReader.readArrowIPC(['name']))
+  assert.deepEqual([...readBack.getChild('name')], ['a', 'b', 'a'])
+  ipcReader.close()
+}
@@ -0,0 +1,147 @@
+/*
+ * datasetWriter.js
+ */
+
+const fs = require('fs')
+const path = require('path')
+const assert = require('assert')
+const lib = require('../lib')
+const type = lib.type
+
+const schema = {
+  date: { type: type.STRING },
+  id: { type: type.INT64 },
+  value: { type: type.DOUBLE },
+}
+
+const dates = ['2026-10-16', '2026-10-17', '2026-10-18']
+const rowCount = 3000
+
+function readRows(filepath) {
+  const reader = lib.ParquetReader.openFile(filepath)
+  const rows = []
+  for (let i = 0; i < reader.getRowCount(); i++)
+    rows.push(reader.readRow(i))
+  reader.close()
+  return rows
+}
+
+// Hive-style partitioning
+fs.rmSync('test-out-hive', { recursive: true, force: true })
+const hive = new lib.ParquetDatasetWriter(schema, 'test-out-hive', {
+  partitionBy: ['date'],
+  maxRowsPerFile: 400,
+})
+hive.setRowGroupSize(128)
+hive.open()
+for (let i = 0; i < rowCount; i++) {
+  hive.appendRowObject({ date: dates[i % dates.length], id: i, value: i / 2 })
+}
+hive.close()
+
+assert.deepEqual(fs.readdirSync('test-out-hive').sort(), dates.map(d => 'date=' + d))
+
+for (const date of dates) {
+  const directory = path.join('test-out-hive', 'date=' + date)
+  const files = fs.readdirSync(directory)
+  assert.ok(files.length >= 3)
+  for (const file of files)
+    assert.ok(readRows(path.join(directory, file)).length <= 400)
+
+  const rows = readRows(directory)
+  assert.equal(rows.length, rowCount / dates.length)
+  assert.ok(rows.every(row => row.date === date))
+}
+
+const hiveReader = lib.ParquetReader.openFile('test-out-hive')
+assert.equal(hiveReader.getRowCount(), rowCount)
+assert.deepEqual(hiveReader.getColumnNames(), Object.keys(schema))
+hiveReader.close()
+
+// Null, empty and sentinel-looking values get distinct directories
+fs.rmSync('test-out-hive-special', { recursive: true, force: true })
+const special = new lib.ParquetDatasetWriter(schema, 'test-out-hive-special', { partitionBy: ['date'] })
+special.open()
+special.appendRow([null, 0, 0])
+special.appendRow(['', 1, 0])
+special.appendRow(['__HIVE_DEFAULT_PARTITION__', 2, 0])
+special.appendRow(['a/b', 3, 0])
+special.close()
+assert.equal(fs.readdirSync('test-out-hive-special').length, 4)
+assert.ok(fs.existsSync('test-out-hive-special/date=__HIVE_DEFAULT_PARTITION__'))
+
+// Partitions beyond maxOpenPartitions are closed and continue in a new file
+fs.rmSync('test-out-hive-lru', { recursive: true, force: true })
+const lru = new lib.ParquetDatasetWriter(schema, 'test-out-hive-lru', {
+  partitionBy: ['date'],
+  maxOpenPartitions: 1,
+})
+lru.open()
+for (let i = 0; i < rowCount; i++) {
+  lru.appendRow([dates[Math.floor(i / 100) % dates.length], i, i / 2])
+}
+lru.close()
+for (const date of dates) {
+  const directory = path.join('test-out-hive-lru', 'date=' + date)
+  assert.equal(fs.readdirSync(directory).length, 10)
+  assert.ok(readRows(directory).every(row => row.date === date))
+}
+
+// Round-robin deals batches over concurrency files
+fs.rmSync('test-out-rr', { recursive: true, force: true })
+const roundRobin = new lib.ParquetDatasetWriter(schema, 'test-out-rr', {
+  concurrency: 4,
+  maxRowsPerFile: 500,
+})
+roundRobin.setRowGroupSize(100)
+roundRobin.open()
+for (let i = 0; i < rowCount; i++) {
+  roundRobin.appendRow([dates[0], i, i / 2])
+}
+roundRobin.close()
+
+const rrFiles = fs.readdirSync('test-out-rr')
+assert.ok(rrFiles.length >= 6)
+for (const file of rrFiles)
+  assert.ok(readRows(path.join('test-out-rr', file)).length <= 500)
+const rrIds = readRows('test-out-rr').map(row => Number(row.id)).sort((a, b) => a - b)
+assert.deepEqual(rrIds, [...Array(rowCount).keys()])
+
+// preserveOrder keeps rows in order across files
+fs.rmSync('test-out-rr-ordered', { recursive: true, force: true })
+const ordered = new lib.ParquetDatasetWriter(schema, 'test-out-rr-ordered', {
+  concurrency: 4,
+  maxRowsPerFile: 500,
+  preserveOrder: true,
+})
+ordered.open()
+for (let i = 0; i < rowCount; i++) {
+  ordered.appendRow([dates[0], i, i / 2])
+}
+ordered.close()
+
+assert.equal(fs.readdirSync('test-out-rr-ordered').length, 6)
+assert.deepEqual(readRows('test-out-rr-ordered').map(row => row.id), [...Array(rowCount).keys()])
+
+// maxBytesPerFile rolls files over on the size of the appended values
+fs.rmSync('test-out-rr-bytes', { recursive: true, force: true })
+const bySize = new lib.ParquetDatasetWriter(schema, 'test-out-rr-bytes', {
+  maxBytesPerFile: 100 * (10 + 8 + 8),
+  preserveOrder: true,
+})
+bySize.open()
+for (let i = 0; i < 1000; i++) {
+  bySize.appendRow([dates[0], i, i / 2])
+}
+bySize.close()
+assert.equal(fs.readdirSync('test-out-rr-bytes').length, 10)
+
+// A small write without file limits gives a single file
+fs.rmSync('test-out-rr-small', { recursive: true, force: true })
+const small = new lib.ParquetDatasetWriter(schema, 'test-out-rr-small')
+small.open()
+for (let i = 0; i < 10; i++) {
+  small.appendRow([dates[0], i, i / 2])
+}
+small.close()
+assert.equal(fs.readdirSync('test-out-rr-small').length, 1)
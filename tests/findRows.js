@@ -0,0 +1,85 @@
+/*
+ * findRows.js
+ */
+
+const assert = require('assert')
+const lib = require('../lib')
+const type = lib.type
+
+const schema = {
+  id: { type: type.INT64 },
+  name: { type: type.STRING },
+}
+
+const rowCount = 5000
+
+function write(filepath, indexColumns) {
+  const writer = new lib.ParquetWriter(schema, filepath)
+  writer.setRowGroupSize(500)
+  if (indexColumns)
+    writer.setIndexColumns(indexColumns)
+  writer.open()
+  for (let i = 0; i < rowCount; i++) {
+    writer.appendRow([i, 'name-' + (i % 100)])
+  }
+  writer.close()
+}
+
+for (const indexColumns of [null, ['id', 'name']]) {
+  write('test-out-find.parquet', indexColumns)
+
+  const reader = lib.ParquetReader.openFile('test-out-find.parquet')
+  assert.deepEqual(reader.findRows('id', 1234), [1234])
+  assert.deepEqual(reader.findRows('id', [4999, 0, 17]), [0, 17, 4999])
+  assert.deepEqual(reader.findRows('id', -1), [])
+  assert.equal(reader.findRows('name', 'name-7').length, rowCount / 100)
+  assert.deepEqual(reader.findRows('name', 'missing'), [])
+  reader.close()
+}
+
+// A sidecar from another version of the file, or a corrupt one, is ignored
+const fs = require('fs')
+
+write('test-out-find.parquet', ['id'])
+const staleIndex = fs.readFileSync('test-out-find.parquet.idx')
+
+const rewriter = new lib.ParquetWriter(schema, 'test-out-find.parquet')
+rewriter.open()
+for (let i = 0; i < 10; i++) {
+  rewriter.appendRow([i + 100, 'rewritten'])
+}
+rewriter.close()
+
+for (const sidecar of [staleIndex, Buffer.from('CPQIDX3\0garbage-garbage-garbage')]) {
+  fs.writeFileSync('test-out-find.parquet.idx', sidecar)
+  const reader = lib.ParquetReader.openFile('test-out-find.parquet')
+  assert.deepEqual(reader.findRows('id', [105, 1234]), [5])
+  reader.close()
+}
+
+// Probes must match the column's type; null matches nothing
+write('test-out-find.parquet', ['id'])
+const strict = lib.ParquetReader.openFile('test-out-find.parquet')
+assert.deepEqual(strict.findRows('id', null), [])
+assert.deepEqual(strict.findRows('id', undefined), [])
+assert.deepEqual(strict.findRows('id', 1.5), [])
+assert.deepEqual(strict.findRows('id', [null, 3]), [3])
+assert.deepEqual(strict.findRows('name', null), [])
+assert.throws(() => strict.findRows('id', 'abc'), TypeError)
+assert.throws(() => strict.findRows('name', 7), TypeError)
+strict.close()
+
+// -0.0 and 0.0 are the same value, with and without the sidecar
+for (const indexColumns of [[], ['score']]) {
+  const writer = new lib.ParquetWriter({ score: { type: type.DOUBLE } }, 'test-out-find-zero.parquet')
+  writer.setIndexColumns(indexColumns)
+  writer.open()
+  for (const score of [-0, 0, 1.5, -0])
+    writer.appendRow([score])
+  writer.close()
+
+  const reader = lib.ParquetReader.openFile('test-out-find-zero.parquet')
+  assert.deepEqual(reader.findRows('score', 0), [0, 1, 3])
+  assert.deepEqual(reader.findRows('score', -0), [0, 1, 3])
+  reader.close()
+}
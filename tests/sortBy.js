@@ -0,0 +1,72 @@
+/*
+ * sortBy.js
+ */
+
+const fs = require('fs')
+const assert = require('assert')
+const lib = require('../lib')
+const type = lib.type
+
+const schema = {
+  group: { type: type.STRING },
+  id: { type: type.INT64 },
+}
+
+const rowCount = 1000
+
+const writer = new lib.ParquetWriter(schema, 'test-out-sorted.parquet', {
+  sortBy: [
+    { column: 'group' },
+    { column: 'id', order: 'desc' },
+  ],
+})
+writer.open()
+for (let i = 0; i < rowCount; i++) {
+  writer.appendRow([i % 2 ? 'b' : 'a', (i * 7919) % rowCount])
+}
+writer.close()
+
+const sortingColumns = [
+  { column: 'group', order: 'asc' },
+  { column: 'id', order: 'desc' },
+]
+
+/** Checks that rows [start, end) follow sortingColumns */
+function assertSorted(reader, start, end) {
+  for (let i = start + 1; i < end; i++) {
+    const previous = reader.readRow(i - 1)
+    const current = reader.readRow(i)
+    assert.ok(previous.group <= current.group)
+    if (previous.group === current.group)
+      assert.ok(previous.id > current.id)
+  }
+}
+
+const reader = lib.ParquetReader.openFile('test-out-sorted.parquet')
+assert.equal(reader.getRowCount(), rowCount)
+assert.deepEqual(reader.getSortingColumns(), sortingColumns)
+assertSorted(reader, 0, rowCount)
+reader.close()
+
+// The dataset writer sorts each batch, and records the order per row group
+const batchRows = 100
+
+fs.rmSync('test-out-sorted-dataset', { recursive: true, force: true })
+const datasetWriter = new lib.ParquetDatasetWriter(schema, 'test-out-sorted-dataset', {
+  concurrency: 2,
+  sortBy: sortingColumns,
+})
+datasetWriter.setRowGroupSize(batchRows)
+datasetWriter.open()
+for (let i = 0; i < rowCount; i++) {
+  datasetWriter.appendRow([i % 2 ? 'b' : 'a', (i * 7919) % rowCount])
+}
+datasetWriter.close()
+
+const datasetReader = lib.ParquetReader.openFile('test-out-sorted-dataset')
+assert.equal(datasetReader.getRowCount(), rowCount)
+assert.deepEqual(datasetReader.getSortingColumns(), sortingColumns)
+for (let start = 0; start < rowCount; start += batchRows) {
+  assertSorted(datasetReader, start, start + batchRows)
+}
+datasetReader.close()